@@ -0,0 +1,239 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Build time benchmark. Every benchmark case builds a single chart from
+// deterministic synthetic data in a separate process, and reports the build
+// time, the peak memory usage of the process, and the size of the output.
+//
+// Usage: bench [-n max_points] [-t type] [-d data] [-m mode]
+//
+// The number of data points goes from 1e3 to max_points (default 1e6) in
+// steps of 10x. Note that series types with string X-values hold one
+// category per data point. Tags are only benchmarked up to 1e4 points.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <chart_ensemble.h>
+
+#include <cstring>
+#include <random>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Chart;
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct type_t {
+  const char* name;
+  SeriesType  type;
+  bool        is_cat;
+};
+
+const type_t type_list[] = {
+  { "XY"         , SeriesType::XY         , false },
+  { "Scatter"    , SeriesType::Scatter    , false },
+  { "Line"       , SeriesType::Line       , true  },
+  { "Point"      , SeriesType::Point      , true  },
+  { "Lollipop"   , SeriesType::Lollipop   , true  },
+  { "Bar"        , SeriesType::Bar        , true  },
+  { "StackedBar" , SeriesType::StackedBar , true  },
+  { "LayeredBar" , SeriesType::LayeredBar , true  },
+  { "Area"       , SeriesType::Area       , true  },
+  { "StackedArea", SeriesType::StackedArea, true  },
+};
+
+enum class Data { Walk, Sine, Sparse, Heavy };
+
+const char* data_names[] = { "walk", "sine", "sparse", "heavy" };
+
+enum class Mode { Lin, Log, Tags, HTML };
+
+const char* mode_names[] = { "lin", "log", "tags", "html" };
+
+struct case_t {
+  const type_t* type;
+  Data          data;
+  Mode          mode;
+  size_t        n;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Generate the synthetic data; the same seed is used for every case.
+void Generate(
+  Data data, size_t n, bool log,
+  std::vector< double >& x, std::vector< double >& y
+)
+{
+  std::mt19937_64 rng( 12345 );
+  std::normal_distribution< double > normal;
+  std::cauchy_distribution< double > cauchy;
+  std::uniform_real_distribution< double > uniform;
+
+  x.resize( n );
+  y.resize( n );
+  double v = 0;
+  for ( size_t i = 0; i < n; ++i ) {
+    x[ i ] = i;
+    switch ( data ) {
+      case Data::Walk :
+        v += normal( rng );
+        y[ i ] = v;
+        break;
+      case Data::Sine :
+        y[ i ] = 10 * std::sin( 20 * M_PI * i / n ) + normal( rng );
+        break;
+      case Data::Sparse :
+        {
+          v += normal( rng );
+          double u = uniform( rng );
+          y[ i ] = (u < 0.10) ? num_skip : ((u < 0.15) ? num_invalid : v);
+        }
+        break;
+      case Data::Heavy :
+        x[ i ] = std::clamp( cauchy( rng ), -1e6, +1e6 );
+        y[ i ] = std::clamp( cauchy( rng ), -1e6, +1e6 );
+        break;
+    }
+    if ( log && y[ i ] != num_skip && y[ i ] != num_invalid ) {
+      y[ i ] = std::abs( y[ i ] ) + 1;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// Stream buffer discarding all output.
+class NullBuf : public std::streambuf
+{
+protected:
+  int_type overflow( int_type ch ) override { return ch; }
+  std::streamsize xsputn( const char*, std::streamsize n ) override
+  {
+    return n;
+  }
+};
+
+//-----------------------------------------------------------------------------
+
+void Run( const case_t& c )
+{
+  std::vector< double > x;
+  std::vector< double > y;
+  Generate( c.data, c.n, c.mode == Mode::Log, x, y );
+
+  Ensemble ensemble;
+  ensemble.EnableHTML( c.mode == Mode::HTML );
+  ensemble.NewChart( 0, 0, 0, 0 );
+  Main* chart = ensemble.LastChart();
+  chart->SetTitle( "Benchmark" );
+  if ( c.mode == Mode::Log ) chart->AxisY()->SetLogScale();
+  if ( c.type->is_cat ) {
+    for ( size_t i = 0; i < c.n; ++i ) chart->AddCategory( "" );
+  }
+
+  Series* series = chart->AddSeries( c.type->type );
+  series->SetName( "Series" );
+  series->SetTagEnable( c.mode == Mode::Tags );
+  if ( c.type->is_cat ) {
+    series->AddBorrowed( y );
+  } else {
+    series->AddBorrowed( x, y );
+  }
+
+  NullBuf null_buf;
+  std::ostream os( &null_buf );
+  ensemble.Build( os );
+  const Stats& stats = ensemble.GetStats();
+
+  struct rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+
+  printf(
+    "%-11s %-6s %-4s %9zu %10.1f %9.1f %12llu\n",
+    c.type->name, data_names[ int( c.data ) ], mode_names[ int( c.mode ) ],
+    c.n, stats.time_ms, usage.ru_maxrss / 1024.0,
+    static_cast< unsigned long long >( stats.bytes )
+  );
+  fflush( stdout );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main( int argc, char* argv[] )
+{
+  size_t max_n = 1000000;
+  const char* type_sel = nullptr;
+  const char* data_sel = nullptr;
+  const char* mode_sel = nullptr;
+
+  for ( int i = 1; i + 1 < argc; i += 2 ) {
+    if ( strcmp( argv[ i ], "-n" ) == 0 ) {
+      max_n = std::atof( argv[ i + 1 ] );
+    } else
+    if ( strcmp( argv[ i ], "-t" ) == 0 ) {
+      type_sel = argv[ i + 1 ];
+    } else
+    if ( strcmp( argv[ i ], "-d" ) == 0 ) {
+      data_sel = argv[ i + 1 ];
+    } else
+    if ( strcmp( argv[ i ], "-m" ) == 0 ) {
+      mode_sel = argv[ i + 1 ];
+    } else {
+      fprintf(
+        stderr, "Usage: %s [-n max_points] [-t type] [-d data] [-m mode]\n",
+        argv[ 0 ]
+      );
+      return 1;
+    }
+  }
+
+  // All datasets are benchmarked in linear mode, whereas the other modes only
+  // use the random walk dataset.
+  std::vector< case_t > case_list;
+  for ( size_t n = 1000; n <= max_n; n *= 10 ) {
+    for ( const type_t& type : type_list ) {
+      if ( type_sel && strcmp( type_sel, type.name ) != 0 ) continue;
+      for ( int d = 0; d < 4; ++d ) {
+        if ( data_sel && strcmp( data_sel, data_names[ d ] ) != 0 ) continue;
+        for ( int m = 0; m < 4; ++m ) {
+          if ( mode_sel && strcmp( mode_sel, mode_names[ m ] ) != 0 ) continue;
+          if ( Mode( m ) != Mode::Lin && Data( d ) != Data::Walk ) continue;
+          if ( Mode( m ) == Mode::Tags && n > 10000 ) continue;
+          case_list.push_back( { &type, Data( d ), Mode( m ), n } );
+        }
+      }
+    }
+  }
+
+  printf(
+    "%-11s %-6s %-4s %9s %10s %9s %12s\n",
+    "type", "data", "mode", "points", "build_ms", "peak_MB", "bytes"
+  );
+  fflush( stdout );
+
+  // Each case runs in its own process in order to measure its peak memory
+  // usage.
+  int failed = 0;
+  for ( const case_t& c : case_list ) {
+    pid_t pid = fork();
+    if ( pid == 0 ) {
+      Run( c );
+      _exit( 0 );
+    }
+    int status = 0;
+    if ( pid < 0 || waitpid( pid, &status, 0 ) < 0 || status != 0 ) {
+      printf(
+        "%-11s %-6s %-4s %9zu FAILED\n",
+        c.type->name, data_names[ int( c.data ) ], mode_names[ int( c.mode ) ],
+        c.n
+      );
+      failed++;
+    }
+  }
+
+  return (failed > 0) ? 1 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -532,6 +532,37 @@ U Axis::Coor( double v )
   return c;
 }
 
+// The loops are kept free of branches so that the compiler can vectorize them.
+void Axis::CoorBatch( const double* in, double* out, size_t n )
+{
+  const double len = length;
+  double a = min;
+  double b = max;
+  if ( log_scale ) {
+    a = std::log10( min );
+    b = std::log10( max );
+    for ( size_t i = 0; i < n; ++i ) {
+      double v = in[ i ];
+      out[ i ] = (v > 0) ? (std::log10( v ) - a) * len / (b - a) : -coor_hi;
+    }
+  } else {
+    for ( size_t i = 0; i < n; ++i ) {
+      out[ i ] = (in[ i ] - a) * len / (b - a);
+    }
+  }
+  if ( reverse ) {
+    for ( size_t i = 0; i < n; ++i ) {
+      out[ i ] = len - out[ i ];
+    }
+  }
+  for ( size_t i = 0; i < n; ++i ) {
+    double c = out[ i ];
+    c = (c < -coor_hi) ? -coor_hi : c;
+    c = (c > +coor_hi) ? +coor_hi : c;
+    out[ i ] = c;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 // Compute number of required decimals. If update=true then the digits and
@@ -714,7 +745,7 @@ SVG::Group* Axis::BuildNum( SVG::Group* g, double v, bool bold )
       }
     }
     s += number_unit;
-    g = label_db->CreateInDB( g, s );
+    g = label_db->CreateInDB( g, s, 0, false, &num_font );
     if ( bold ) g->Attr()->TextFont()->SetBold();
     return g;
   }
@@ -728,7 +759,7 @@ SVG::Group* Axis::BuildNum( SVG::Group* g, double v, bool bold )
 
   if ( number_format == NumberFormat::Fixed ) {
     s += number_unit;
-    g = label_db->CreateInDB( g, s );
+    g = label_db->CreateInDB( g, s, 0, false, &num_font );
     if ( bold ) g->Attr()->TextFont()->SetBold();
     return g;
   }
@@ -748,7 +779,7 @@ SVG::Group* Axis::BuildNum( SVG::Group* g, double v, bool bold )
     } else {
       s += "×10";
     }
-    container = label_db->CreateInDB( g, s );
+    container = label_db->CreateInDB( g, s, 0, false, &num_font );
   }
 
   // Build exponent part,
@@ -795,8 +826,8 @@ SVG::Group* Axis::BuildNum( SVG::Group* g, double v, bool bold )
 void Axis::BuildTicksHelper(
   double v, SVG::U v_coor, int32_t sn, bool at_zero,
   SVG::U min_coor, SVG::U max_coor, SVG::U eps_coor,
-  std::vector< SVG::Object* >& avoid_objects,
-  std::vector< SVG::Object* >& num_objects,
+  AvoidSet& avoid_objects,
+  AvoidSet& num_objects,
   SVG::Group* minor_g, SVG::Group* major_g, SVG::Group* zero_g,
   SVG::Group* line_g, SVG::Group* num_g
 )
@@ -952,7 +983,7 @@ void Axis::BuildTicksHelper(
       label_db->Delete( obj );
       num_g->DeleteFront();
     } else {
-      num_objects.push_back( obj );
+      num_objects.Add( obj );
     }
   }
 
@@ -962,7 +993,7 @@ void Axis::BuildTicksHelper(
 //------------------------------------------------------------------------------
 
 void Axis::BuildTicksNumsLinear(
-  std::vector< SVG::Object* >& avoid_objects,
+  AvoidSet& avoid_objects,
   SVG::Group* minor_g, SVG::Group* major_g, SVG::Group* zero_g,
   SVG::Group* line_g, SVG::Group* num_g
 )
@@ -1014,7 +1045,7 @@ void Axis::BuildTicksNumsLinear(
     }
   }
 
-  std::vector< SVG::Object* > num_objects;
+  AvoidSet num_objects;
 
   U min_coor = 0;
   U max_coor = length;
@@ -1045,7 +1076,7 @@ void Axis::BuildTicksNumsLinear(
 //------------------------------------------------------------------------------
 
 void Axis::BuildTicksNumsLogarithmic(
-  std::vector< SVG::Object* >& avoid_objects,
+  AvoidSet& avoid_objects,
   SVG::Group* minor_g, SVG::Group* major_g, SVG::Group* zero_g,
   SVG::Group* line_g, SVG::Group* num_g
 )
@@ -1109,7 +1140,7 @@ void Axis::BuildTicksNumsLogarithmic(
     }
   }
 
-  std::vector< SVG::Object* > num_objects;
+  AvoidSet num_objects;
 
   U min_coor = 0;
   U max_coor = length;
@@ -1148,7 +1179,7 @@ void Axis::BuildTicksNumsLogarithmic(
 
 void Axis::BuildCategories(
   const std::vector< std::string >& category_list,
-  std::vector< SVG::Object* >& avoid_objects,
+  AvoidSet& avoid_objects,
   SVG::Group* minor_g, SVG::Group* major_g, SVG::Group* cat_g
 )
 {
@@ -1206,7 +1237,7 @@ void Axis::BuildCategories(
     }
   }
 
-  std::vector< SVG::Object* > cat_objects;
+  AvoidSet cat_objects;
   std::vector< uint32_t > mn_list;
 
   uint32_t min_stride =
@@ -1266,16 +1297,16 @@ void Axis::BuildCategories(
           if ( commit && Chart::Collides( obj, avoid_objects, mx, 0 ) ) {
             cat_g->DeleteFront();
           } else {
-            cat_objects.push_back( obj );
+            cat_objects.Add( obj );
             if ( commit ) mn_list.push_back( cat_idx );
           }
         }
         ++cat_idx;
       }
       if ( commit ) break;
-      while ( !cat_objects.empty() ) {
+      while ( !cat_objects.Empty() ) {
         cat_g->DeleteFront();
-        cat_objects.pop_back();
+        cat_objects.RemoveLast();
       }
       if ( !collision ) break;
       if ( angle != 0 ) break;
@@ -1330,7 +1361,7 @@ void Axis::BuildCategories(
 
 void Axis::BuildUnit(
   SVG::Group* unit_g,
-  std::vector< SVG::Object* >& avoid_objects
+  AvoidSet& avoid_objects
 )
 {
   if ( unit.empty() ) return;
@@ -1601,7 +1632,7 @@ void Axis::BuildUnit(
     }
   }
 
-  avoid_objects.push_back( obj );
+  avoid_objects.Add( obj );
 
   return;
 }
@@ -1611,7 +1642,7 @@ void Axis::BuildUnit(
 void Axis::Build(
   const std::vector< std::string >& category_list,
   uint32_t phase,
-  std::vector< SVG::Object* >& avoid_objects,
+  AvoidSet& avoid_objects,
   SVG::Group* minor_g, SVG::Group* major_g, SVG::Group* zero_g,
   SVG::Group* line_g, SVG::Group* num_g, SVG::Group* unit_g
 )
@@ -1668,21 +1699,33 @@ void Axis::Build(
 
   line_g = line_g->AddNewGroup();
   num_g = num_g->AddNewGroup();
-  num_g->Attr()->TextFont()->SetSize( 14 * number_size );
+  num_font = { 14 * number_size, 0, 0, 0, false };
+  num_g->Attr()->TextFont()->SetSize( num_font.size );
   if ( !category_axis ) {
     // Reset letter spacing to default, but offset the baseline such that
     // numbers are vertically centered in their boundary box. Numbers have no
     // glyph below the baseline and will therefore appear vertically un-centered
     // without this adjustment.
+    num_font.width_factor    = 1.0;
+    num_font.height_factor   = 1.0;
+    num_font.baseline_factor = 0.6;
     num_g->Attr()->TextFont()
-      ->SetWidthFactor( 1.0 )
-      ->SetHeightFactor( 1.0 )
-      ->SetBaselineFactor( 0.6 );
+      ->SetWidthFactor( num_font.width_factor )
+      ->SetHeightFactor( num_font.height_factor )
+      ->SetBaselineFactor( num_font.baseline_factor );
   }
   {
-    num_g->Add( new Text( "X" ) );
-    BoundaryBox bb = num_g->Last()->GetBB();
-    num_g->DeleteFront();
+    BoundaryBox bb =
+      label_db->text_cache->GetBB(
+        num_font, "X",
+        [&]( void )
+        {
+          num_g->Add( new Text( "X" ) );
+          BoundaryBox char_bb = num_g->Last()->GetBB();
+          num_g->DeleteFront();
+          return char_bb;
+        }
+      );
     num_char_w = bb.max.x - bb.min.x;
     num_char_h = bb.max.y - bb.min.y;
   }
@@ -1749,9 +1792,9 @@ void Axis::Build(
       }
     }
     if ( angle == 0 ) {
-      avoid_objects.push_back( new Rect( oc - zc, os, oc + zc, oe ) );
+      avoid_objects.Add( new Rect( oc - zc, os, oc + zc, oe ) );
     } else {
-      avoid_objects.push_back( new Rect( os, oc - zc, oe, oc + zc ) );
+      avoid_objects.Add( new Rect( os, oc - zc, oe, oc + zc ) );
     }
     dmz_cnt++;
   }
@@ -1765,9 +1808,9 @@ void Axis::Build(
       U os = 0;
       U oe = orth_length;
       if ( angle == 0 ) {
-        avoid_objects.push_back( new Rect( oc - zc, os, oc + zc, oe ) );
+        avoid_objects.Add( new Rect( oc - zc, os, oc + zc, oe ) );
       } else {
-        avoid_objects.push_back( new Rect( os, oc - zc, oe, oc + zc ) );
+        avoid_objects.Add( new Rect( os, oc - zc, oe, oc + zc ) );
       }
       dmz_cnt++;
     }
@@ -1823,13 +1866,13 @@ void Axis::Build(
 
   // Remove DMZ rectangles.
   while ( dmz_cnt > 0 ) {
-    delete avoid_objects.back();
-    avoid_objects.pop_back();
+    delete avoid_objects.Last();
+    avoid_objects.RemoveLast();
     dmz_cnt--;
   }
 
-  avoid_objects.push_back( line_g );
-  avoid_objects.push_back( num_g );
+  avoid_objects.Add( line_g );
+  avoid_objects.Add( num_g );
 
   return;
 }
@@ -1837,7 +1880,7 @@ void Axis::Build(
 ////////////////////////////////////////////////////////////////////////////////
 
 void Axis::BuildLabel(
-  std::vector< SVG::Object* >& avoid_objects,
+  AvoidSet& avoid_objects,
   SVG::Group* label_g
 )
 {
@@ -1918,8 +1961,8 @@ void Axis::BuildLabel(
 
   MoveObjs( dir, label_objs, avoid_objects, space_x, space_y );
 
-  if ( lab0 ) avoid_objects.push_back( lab0 );
-  if ( lab1 ) avoid_objects.push_back( lab1 );
+  if ( lab0 ) avoid_objects.Add( lab0 );
+  if ( lab1 ) avoid_objects.Add( lab1 );
 
   return;
 }
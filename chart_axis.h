@@ -114,6 +114,10 @@ public:
   // Convert a value to an SVG coordinate.
   SVG::U Coor( double v );
 
+  // Convert n values to SVG coordinates; same as calling Coor() for each
+  // value, but the axis parameters are evaluated only once.
+  void CoorBatch( const double* in, double* out, size_t n );
+
   // Determine if value is valid.
   bool Valid( double v )
   {
@@ -129,43 +133,43 @@ public:
   void BuildTicksHelper(
     double v, SVG::U v_coor, int32_t sn, bool at_zero,
     SVG::U min_coor, SVG::U max_coor, SVG::U eps_coor,
-    std::vector< SVG::Object* >& avoid_objects,
-    std::vector< SVG::Object* >& num_objects,
+    AvoidSet& avoid_objects,
+    AvoidSet& num_objects,
     SVG::Group* minor_g, SVG::Group* major_g, SVG::Group* zero_g,
     SVG::Group* line_g, SVG::Group* num_g
   );
   void BuildTicksNumsLinear(
-    std::vector< SVG::Object* >& avoid_objects,
+    AvoidSet& avoid_objects,
     SVG::Group* minor_g, SVG::Group* major_g, SVG::Group* zero_g,
     SVG::Group* line_g, SVG::Group* num_g
   );
   void BuildTicksNumsLogarithmic(
-    std::vector< SVG::Object* >& avoid_objects,
+    AvoidSet& avoid_objects,
     SVG::Group* minor_g, SVG::Group* major_g, SVG::Group* zero_g,
     SVG::Group* line_g, SVG::Group* num_g
   );
 
   void BuildCategories(
     const std::vector< std::string >& category_list,
-    std::vector< SVG::Object* >& avoid_objects,
+    AvoidSet& avoid_objects,
     SVG::Group* minor_g, SVG::Group* major_g, SVG::Group* cat_g
   );
 
   void BuildUnit(
     SVG::Group* unit_g,
-    std::vector< SVG::Object* >& avoid_objects
+    AvoidSet& avoid_objects
   );
 
   void Build(
     const std::vector< std::string >& category_list,
     uint32_t phase,
-    std::vector< SVG::Object* >& avoid_objects,
+    AvoidSet& avoid_objects,
     SVG::Group* minor_g, SVG::Group* major_g, SVG::Group* zero_g,
     SVG::Group* line_g, SVG::Group* num_g, SVG::Group* unit_g
   );
 
   void BuildLabel(
-    std::vector< SVG::Object* >& avoid_objects,
+    AvoidSet& avoid_objects,
     SVG::Group* label_g
   );
 
@@ -197,6 +201,10 @@ public:
   SVG::U num_char_w;
   SVG::U num_char_h;
 
+  // Font of the numbers, used as key when measuring them through the text
+  // cache of the ensemble.
+  TextCache::font_t num_font;
+
   bool         log_scale;
   NumberFormat number_format;
   bool         number_sign;
@@ -13,20 +13,175 @@
 
 #include <chart_common.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 using namespace SVG;
 
 ///////////////////////////////////////////////////////////////////////////////
 
+int64_t Chart::BBGrid::Cell( double v )
+{
+  double c = std::floor( v / cell_size );
+  return static_cast< int64_t >( std::clamp( c, -1e9, +1e9 ) );
+}
+
+void Chart::BBGrid::Add( uint32_t idx, const BoundaryBox& bb )
+{
+  int64_t x1 = Cell( bb.min.x );
+  int64_t x2 = Cell( bb.max.x );
+  int64_t y1 = Cell( bb.min.y );
+  int64_t y2 = Cell( bb.max.y );
+  if ( (x2 - x1 + 1) * (y2 - y1 + 1) > max_cells ) {
+    large_list.push_back( idx );
+    return;
+  }
+  for ( int64_t y = y1; y <= y2; ++y ) {
+    for ( int64_t x = x1; x <= x2; ++x ) {
+      cell_map[ Key( x, y ) ].push_back( idx );
+    }
+  }
+}
+
+void Chart::BBGrid::RemoveLast( uint32_t idx, const BoundaryBox& bb )
+{
+  if ( !large_list.empty() && large_list.back() == idx ) {
+    large_list.pop_back();
+    return;
+  }
+  // The bounding box is last in all its cells.
+  for ( int64_t y = Cell( bb.min.y ); y <= Cell( bb.max.y ); ++y ) {
+    for ( int64_t x = Cell( bb.min.x ); x <= Cell( bb.max.x ); ++x ) {
+      auto it = cell_map.find( Key( x, y ) );
+      it->second.pop_back();
+      if ( it->second.empty() ) cell_map.erase( it );
+    }
+  }
+}
+
+bool Chart::BBGrid::Find(
+  const BoundaryBox& bb, double margin_x, double margin_y,
+  std::vector< uint32_t >& idx_list
+) const
+{
+  int64_t x1 = Cell( bb.min.x - margin_x );
+  int64_t x2 = Cell( bb.max.x + margin_x );
+  int64_t y1 = Cell( bb.min.y - margin_y );
+  int64_t y2 = Cell( bb.max.y + margin_y );
+  if ( (x2 - x1 + 1) * (y2 - y1 + 1) > max_cells ) return false;
+  idx_list.insert( idx_list.end(), large_list.begin(), large_list.end() );
+  for ( int64_t y = y1; y <= y2; ++y ) {
+    for ( int64_t x = x1; x <= x2; ++x ) {
+      auto it = cell_map.find( Key( x, y ) );
+      if ( it == cell_map.end() ) continue;
+      idx_list.insert( idx_list.end(), it->second.begin(), it->second.end() );
+    }
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Chart::AvoidSet::Add( SVG::Object* obj )
+{
+  obj_t o{ obj, BoundaryBox(), obj->Empty() };
+  if ( !o.empty ) o.bb = obj->GetBB();
+  if ( !o.empty ) grid.Add( obj_list.size(), o.bb );
+  obj_list.push_back( o );
+}
+
+void Chart::AvoidSet::RemoveLast( void )
+{
+  const obj_t& o = obj_list.back();
+  if ( !o.empty ) grid.RemoveLast( obj_list.size() - 1, o.bb );
+  obj_list.pop_back();
+}
+
+void Chart::AvoidSet::Update( void )
+{
+  grid = BBGrid();
+  for ( size_t i = 0; i < obj_list.size(); ++i ) {
+    obj_t& o = obj_list[ i ];
+    o.empty = o.obj->Empty();
+    if ( !o.empty ) o.bb = o.obj->GetBB();
+    if ( !o.empty ) grid.Add( i, o.bb );
+  }
+}
+
+bool Chart::AvoidSet::Near(
+  size_t i, const BoundaryBox& bb, U margin_x, U margin_y
+) const
+{
+  const obj_t& o = obj_list[ i ];
+  if ( o.empty ) return false;
+  double mx = std::max( 0.0, double( margin_x ) ) + epsilon;
+  double my = std::max( 0.0, double( margin_y ) ) + epsilon;
+  return
+    o.bb.min.x <= bb.max.x + mx && bb.min.x <= o.bb.max.x + mx &&
+    o.bb.min.y <= bb.max.y + my && bb.min.y <= o.bb.max.y + my;
+}
+
+void Chart::AvoidSet::Find(
+  const BoundaryBox& bb, U margin_x, U margin_y,
+  std::vector< uint32_t >& idx_list
+) const
+{
+  idx_list.clear();
+  double mx = std::max( 0.0, double( margin_x ) ) + epsilon;
+  double my = std::max( 0.0, double( margin_y ) ) + epsilon;
+  if ( !grid.Find( bb, mx, my, idx_list ) ) {
+    for ( uint32_t i = 0; i < obj_list.size(); ++i ) {
+      if ( Near( i, bb, margin_x, margin_y ) ) idx_list.push_back( i );
+    }
+    return;
+  }
+  std::sort( idx_list.begin(), idx_list.end() );
+  idx_list.erase(
+    std::unique( idx_list.begin(), idx_list.end() ), idx_list.end()
+  );
+  idx_list.erase(
+    std::remove_if(
+      idx_list.begin(), idx_list.end(),
+      [&]( uint32_t i ) { return !Near( i, bb, margin_x, margin_y ); }
+    ),
+    idx_list.end()
+  );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t Chart::TextCache::key_hash_t::operator()( const key_t& key ) const
+{
+  size_t h = std::hash< std::string >()( key.txt );
+  auto mix = [&]( size_t v ) {
+    h ^= v + 0x9E3779B97F4A7C15 + (h << 6) + (h >> 2);
+  };
+  mix( std::hash< double >()( key.font.size ) );
+  mix( std::hash< float >()( key.font.width_factor ) );
+  mix( std::hash< float >()( key.font.height_factor ) );
+  mix( std::hash< float >()( key.font.baseline_factor ) );
+  mix( key.font.bold );
+  return h;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 Object* Chart::Collides(
-  SVG::Object* obj, const std::vector< SVG::Object* >& objects,
+  SVG::Object* obj, const AvoidSet& objects,
   SVG::U margin_x, SVG::U margin_y
 )
 {
   margin_x -= epsilon;
   margin_y -= epsilon;
   if ( obj == nullptr || obj->Empty() ) return nullptr;
-  for ( auto object : objects ) {
-    if ( object->Empty() ) continue;
+  std::vector< uint32_t > idx_list;
+  objects.Find( obj->GetBB(), margin_x, margin_y, idx_list );
+  for ( uint32_t i : idx_list ) {
+    Object* object = objects.Obj( i );
     if ( SVG::Collides( obj, object, margin_x, margin_y ) ) {
       return object;
     }
@@ -40,7 +195,7 @@ Object* Chart::Collides(
 void Chart::MoveObjs(
   Dir dir,
   const std::vector< SVG::Object* >& move_objs,
-  const std::vector< SVG::Object* >& avoid_objs,
+  const AvoidSet& avoid_objs,
   SVG::U margin_x, SVG::U margin_y
 )
 {
@@ -71,7 +226,7 @@ void Chart::MoveObjs(
 void Chart::MoveObj(
   Dir dir,
   SVG::Object* obj,
-  const std::vector< SVG::Object* >& avoid_objs,
+  const AvoidSet& avoid_objs,
   SVG::U margin_x, SVG::U margin_y
 )
 {
@@ -126,3 +281,42 @@ bool Chart::NormalWidthUTF8( const std::string& s )
 }
 
 ///////////////////////////////////////////////////////////////////////////////
+
+void Chart::ParallelFor(
+  size_t n, uint32_t threads,
+  const std::function< void( size_t, uint32_t ) >& func
+)
+{
+  size_t thread_cnt = threads;
+  if ( thread_cnt == 0 ) thread_cnt = std::thread::hardware_concurrency();
+  thread_cnt = std::max( std::min( thread_cnt, n ), size_t( 1 ) );
+
+  std::atomic< size_t > next = 0;
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto worker = [&]( uint32_t w )
+  {
+    while ( true ) {
+      size_t i = next++;
+      if ( i >= n ) break;
+      try {
+        func( i, w );
+      } catch ( ... ) {
+        std::lock_guard< std::mutex > lock( error_mutex );
+        if ( !error ) error = std::current_exception();
+      }
+    }
+  };
+
+  std::vector< std::thread > thread_list;
+  for ( size_t i = 1; i < thread_cnt; ++i ) {
+    thread_list.emplace_back( worker, uint32_t( i ) );
+  }
+  worker( 0 );
+  for ( auto& t : thread_list ) t.join();
+
+  if ( error ) std::rethrow_exception( error );
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -13,6 +13,12 @@
 
 #pragma once
 
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include <svg_canvas.h>
 
 namespace Chart {
@@ -60,22 +66,216 @@ namespace Chart {
     return std::abs( c1 - c2 ) < epsilon;
   }
 
+  // Read-only view of a contiguous sequence of values, similar to the C++20
+  // std::span. It is implicitly constructed from a vector or an array, and
+  // does not own the values.
+  template< typename T >
+  class Span
+  {
+  public:
+
+    Span( void ) = default;
+    Span( const T* data, size_t size ) : ptr( data ), cnt( size ) {}
+    Span( const std::vector< T >& v ) : ptr( v.data() ), cnt( v.size() ) {}
+    template< size_t N >
+    Span( const T (&a)[ N ] ) : ptr( a ), cnt( N ) {}
+
+    const T* data( void ) const { return ptr; }
+    size_t size( void ) const { return cnt; }
+    bool empty( void ) const { return cnt == 0; }
+
+    const T* begin( void ) const { return ptr; }
+    const T* end( void ) const { return ptr + cnt; }
+
+    const T& operator[]( size_t i ) const { return ptr[ i ]; }
+
+    // The first n values.
+    Span first( size_t n ) const { return Span( ptr, n ); }
+
+  private:
+
+    const T* ptr = nullptr;
+    size_t   cnt = 0;
+  };
+
+  // Uniform grid (spatial hash) of bounding boxes identified by an index. It
+  // is used to find the bounding boxes that may be near a given bounding box
+  // without visiting all the bounding boxes.
+  class BBGrid
+  {
+  public:
+
+    // Add a bounding box; the indices must be added in increasing order.
+    void Add( uint32_t idx, const SVG::BoundaryBox& bb );
+
+    // Remove the most recently added bounding box.
+    void RemoveLast( uint32_t idx, const SVG::BoundaryBox& bb );
+
+    // Append the indices of the bounding boxes sharing a cell with the given
+    // bounding box enlarged by the given margins; the indices are unordered
+    // and may contain duplicates. Returns false if the enlarged bounding box
+    // spans so many cells that all bounding boxes should be checked instead.
+    bool Find(
+      const SVG::BoundaryBox& bb, double margin_x, double margin_y,
+      std::vector< uint32_t >& idx_list
+    ) const;
+
+  private:
+
+    static constexpr double cell_size = 32;
+
+    // Bounding boxes spanning more cells than this are kept in large_list.
+    static constexpr int64_t max_cells = 256;
+
+    std::unordered_map< uint64_t, std::vector< uint32_t > > cell_map;
+    std::vector< uint32_t > large_list;
+
+    static int64_t Cell( double v );
+    static uint64_t Key( int64_t x, int64_t y )
+    {
+      return
+        (static_cast< uint64_t >( x ) << 32) ^ static_cast< uint32_t >( y );
+    }
+  };
+
+  // Set of objects which other objects must avoid colliding with. The bounding
+  // boxes of the objects are cached, so Update() must be called if an object
+  // changes after it has been added. The objects are kept in a BBGrid, so
+  // finding the objects that may collide with a given object only visits the
+  // objects near it instead of all the objects.
+  class AvoidSet
+  {
+  public:
+
+    void Add( SVG::Object* obj );
+
+    SVG::Object* Last( void ) const { return obj_list.back().obj; }
+    void RemoveLast( void );
+
+    // Re-read the bounding boxes of all the objects.
+    void Update( void );
+
+    bool Empty( void ) const { return obj_list.empty(); }
+    size_t Size( void ) const { return obj_list.size(); }
+
+    SVG::Object* Obj( size_t i ) const { return obj_list[ i ].obj; }
+    const SVG::BoundaryBox& BB( size_t i ) const { return obj_list[ i ].bb; }
+
+    // Find the non-empty objects whose bounding box comes within the given
+    // margins of the given bounding box. The indices of the objects are
+    // returned in the order in which the objects were added.
+    void Find(
+      const SVG::BoundaryBox& bb, SVG::U margin_x, SVG::U margin_y,
+      std::vector< uint32_t >& idx_list
+    ) const;
+
+    // Returns true if the bounding box of object i comes within the given
+    // margins of the given bounding box.
+    bool Near(
+      size_t i, const SVG::BoundaryBox& bb,
+      SVG::U margin_x = 0, SVG::U margin_y = 0
+    ) const;
+
+  private:
+
+    struct obj_t {
+      SVG::Object*     obj;
+      SVG::BoundaryBox bb;
+      bool             empty;
+    };
+    std::vector< obj_t > obj_list;
+
+    BBGrid grid;
+  };
+
+  // Cache of text boundary boxes shared by the charts of an ensemble, so that
+  // the same text in the same font is only measured once; may be used
+  // concurrently. The SVG objects do not reveal the font in effect, so the
+  // caller must supply the font settings as part of the key. The font family
+  // and the ensemble level width/height/baseline adjustments are the same for
+  // all the text of an ensemble, and are therefore not part of the key.
+  class TextCache
+  {
+  public:
+
+    // The width/height/baseline factors are those set on top of the ensemble
+    // font, where 0 means not set.
+    struct font_t {
+      double size;
+      float  width_factor;
+      float  height_factor;
+      float  baseline_factor;
+      bool   bold;
+      bool operator==( const font_t& f ) const
+      {
+        return
+          size == f.size &&
+          width_factor == f.width_factor &&
+          height_factor == f.height_factor &&
+          baseline_factor == f.baseline_factor &&
+          bold == f.bold;
+      }
+    };
+
+    // Return the boundary box of the text when placed at (0,0) using the given
+    // font; measure() is only called if the text is not already cached.
+    template< typename F >
+    SVG::BoundaryBox GetBB(
+      const font_t& font, const std::string& txt, F measure
+    )
+    {
+      key_t key{ txt, font };
+      {
+        std::lock_guard< std::mutex > lock( mutex );
+        auto it = cache.find( key );
+        if ( it != cache.end() ) return it->second;
+      }
+      SVG::BoundaryBox bb = measure();
+      std::lock_guard< std::mutex > lock( mutex );
+      cache.emplace( std::move( key ), bb );
+      return bb;
+    }
+
+    void Clear( void )
+    {
+      std::lock_guard< std::mutex > lock( mutex );
+      cache.clear();
+    }
+
+  private:
+
+    struct key_t {
+      std::string txt;
+      font_t      font;
+      bool operator==( const key_t& k ) const
+      {
+        return txt == k.txt && font == k.font;
+      }
+    };
+    struct key_hash_t {
+      size_t operator()( const key_t& key ) const;
+    };
+
+    std::unordered_map< key_t, SVG::BoundaryBox, key_hash_t > cache;
+    std::mutex mutex;
+  };
+
   SVG::Object* Collides(
-    SVG::Object* obj, const std::vector< SVG::Object* >& objects,
+    SVG::Object* obj, const AvoidSet& objects,
     SVG::U margin_x = 0, SVG::U margin_y = 0
   );
 
   void MoveObjs(
     Dir dir,
     const std::vector< SVG::Object* >& move_objs,
-    const std::vector< SVG::Object* >& avoid_objs,
+    const AvoidSet& avoid_objs,
     SVG::U margin_x = 0, SVG::U margin_y = 0
   );
 
   void MoveObj(
     Dir dir,
     SVG::Object* obj,
-    const std::vector< SVG::Object* >& avoid_objs,
+    const AvoidSet& avoid_objs,
     SVG::U margin_x = 0, SVG::U margin_y = 0
   );
 
@@ -89,4 +289,13 @@ namespace Chart {
   // characters.
   bool NormalWidthUTF8( const std::string& s );
 
+  // Call func( i, worker ) for i = 0 to n-1 using up to the given number of
+  // threads, where 0 means one per hardware thread. The worker argument
+  // identifies the thread making the call, where 0 is the calling thread. The
+  // first exception thrown by func is rethrown when all calls have finished.
+  void ParallelFor(
+    size_t n, uint32_t threads,
+    const std::function< void( size_t, uint32_t ) >& func
+  );
+
 }
@@ -15,6 +15,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <thread>
 
 using namespace SVG;
 using namespace Chart;
@@ -724,8 +725,55 @@ void Ensemble::MoveCharts( void )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Each chart builds into its own SVG group with its own label, tag, and legend
+// databases, so the charts can be built concurrently. The few shared data
+// structures are either protected by a mutex (HTML legend map, statistics), or
+// merged after all charts are built (global legends).
+void Ensemble::BuildCharts( const std::vector< Main* >& chart_list )
+{
+  // The threads not needed to build the charts themselves are shared among
+  // the charts for building their series.
+  size_t thread_cnt = threads;
+  if ( thread_cnt == 0 ) thread_cnt = std::thread::hardware_concurrency();
+  thread_cnt = std::max( thread_cnt, size_t( 1 ) );
+  size_t chart_threads =
+    std::max( std::min( thread_cnt, chart_list.size() ), size_t( 1 ) );
+  for ( auto chart : chart_list ) {
+    chart->threads = std::max( thread_cnt / chart_threads, size_t( 1 ) );
+  }
+
+  ParallelFor(
+    chart_list.size(), chart_threads,
+    [&]( size_t i, uint32_t )
+    {
+      Stats::Timer timer( &stats, "Main::Build", chart_list[ i ]->id );
+      chart_list[ i ]->Build();
+    }
+  );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 std::string Ensemble::Build( void )
 {
+  std::ostringstream oss;
+  Build( oss );
+  return oss.str();
+}
+
+void Ensemble::BuildGzip( std::ostream& os )
+{
+  GzipBuf gz( os );
+  std::ostream gz_os( &gz );
+  Build( gz_os );
+  gz.Finish();
+}
+
+void Ensemble::Build( std::ostream& os )
+{
+  stats.Reset();
+  text_cache.Clear();
+
   if ( Empty() ) {
     NewChart( 0, 0, 0, 0 );
   }
@@ -743,15 +791,28 @@ std::string Ensemble::Build( void )
   top_g->Attr()->LineColor()->Set( ForegroundColor() );
   top_g->Attr()->FillColor()->Set( BackgroundColor() );
 
-  max_area_pad = 0;
+  std::vector< Main* > chart_list;
   for ( auto& elem : grid.element_list ) {
     if ( elem.chart ) {
-      elem.chart->Build();
-      U area_pad = elem.chart->GetAreaPadding();
-      max_area_pad = std::max( max_area_pad, area_pad );
+      elem.chart->id = chart_list.size();
+      chart_list.push_back( elem.chart );
     }
   }
 
+  BuildCharts( chart_list );
+
+  // Merge the results that are shared among the charts in chart order.
+  max_area_pad = 0;
+  for ( auto chart : chart_list ) {
+    U area_pad = chart->GetAreaPadding();
+    max_area_pad = std::max( max_area_pad, area_pad );
+    for ( auto series : chart->global_legend_list ) {
+      legend_obj->Add( series );
+    }
+  }
+
+  Stats::Timer layout_timer( &stats, "Layout" );
+
   if ( legend_obj->Cnt() == 0 ) {
     SetLegendPos( Pos::Auto );
   }
@@ -771,6 +832,7 @@ std::string Ensemble::Build( void )
   BuildFootnotes();
 
   BuildBackground();
+  layout_timer.Stop();
 
 /*
   {
@@ -798,13 +860,23 @@ std::string Ensemble::Build( void )
   }
 */
 
-  std::ostringstream oss;
+  CountBuf count_buf( os.rdbuf() );
+  std::ostream count_os( &count_buf );
   if ( enable_html ) {
-    oss << html_db->GenHTML( canvas );
+    html_db->GenHTML( canvas, count_os );
   } else {
-    oss << canvas->GenSVG();
+    std::string svg;
+    {
+      Stats::Timer timer( &stats, "GenSVG" );
+      svg = canvas->GenSVG();
+    }
+    stats.objects = Stats::CountElements( svg );
+    count_os << svg;
   }
-  return oss.str();
+  count_os.flush();
+  if ( !count_os ) os.setstate( std::ios_base::badbit );
+  stats.bytes = count_buf.count;
+  stats.time_ms = stats.Now();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
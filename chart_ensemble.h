@@ -13,9 +13,13 @@
 
 #pragma once
 
+#include <ostream>
+
 #include <chart_common.h>
 #include <chart_main.h>
 #include <chart_grid.h>
+#include <chart_gzip.h>
+#include <chart_stats.h>
 
 namespace Chart {
 
@@ -45,6 +49,13 @@ public:
 
   void EnableHTML( bool enable = true ) { enable_html = enable; }
 
+  // Use a compact binary encoding of the HTML snap points, which makes large
+  // HTML pages load much faster.
+  void SetHTMLBinarySnaps( bool enable = true )
+  {
+    html_db->binary_snaps = enable;
+  }
+
   void SetTitle( const std::string& txt );
   void SetSubTitle( const std::string& txt );
   void SetSubSubTitle( const std::string& txt );
@@ -94,9 +105,33 @@ public:
   // Footnote size scaling factor.
   void SetFootnoteSize( float size ) { footnote_size = size; }
 
+  // Number of threads used to build the charts, and the series within the
+  // charts, concurrently; 0 (the default) means one per hardware thread. The
+  // output does not depend on the number of threads.
+  void SetThreads( uint32_t threads ) { this->threads = threads; }
+
   void MoveCharts( void );
+
+  // Build the charts and return the resulting SVG or HTML document.
   std::string Build( void );
 
+  // Same as above, but the document is written to the given stream as it is
+  // generated instead of being accumulated in a string, which reduces the
+  // peak memory usage for large documents.
+  void Build( std::ostream& os );
+
+  // Same as above, but the document is gzip compressed as it is written, e.g.
+  // to produce an SVGZ file.
+  void BuildGzip( std::ostream& os );
+
+  // Timing and size statistics of the most recent Build().
+  const Stats& GetStats( void ) { return stats; }
+
+  Stats stats;
+
+  // Text measurements shared by all the charts.
+  TextCache text_cache;
+
   SVG::Canvas* canvas;
   SVG::Group* top_g;
 
@@ -118,6 +153,11 @@ public:
 
   SVG::U max_area_pad = 0;
 
+  uint32_t threads = 0;
+
+  // Build the charts, using a number of threads.
+  void BuildCharts( const std::vector< Main* >& chart_list );
+
   Grid grid;
 
   void InitGrid( void );
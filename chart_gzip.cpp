@@ -0,0 +1,439 @@
+//
+//  MIT No Attribution License
+//
+//  Copyright 2024, Soren Kragh
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the
+//  “Software”), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so.
+//
+
+#include <chart_gzip.h>
+
+#include <algorithm>
+#include <array>
+#include <queue>
+
+using namespace Chart;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Base values and number of extra bits of the length codes 257 to 285.
+const uint16_t len_base[ 29 ] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const uint8_t len_extra[ 29 ] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+// Base values and number of extra bits of the distance codes 0 to 29.
+const uint16_t dist_base[ 30 ] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577
+};
+const uint8_t dist_extra[ 30 ] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Order in which the code lengths of the code length alphabet are sent.
+const uint8_t cl_order[ 19 ] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+const std::array< uint32_t, 256 > crc_table = []( void )
+{
+  std::array< uint32_t, 256 > table;
+  for ( uint32_t n = 0; n < 256; ++n ) {
+    uint32_t c = n;
+    for ( int k = 0; k < 8; ++k ) {
+      c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+    }
+    table[ n ] = c;
+  }
+  return table;
+}();
+
+uint32_t LenCode( uint32_t len )
+{
+  return std::upper_bound( len_base, len_base + 29, len ) - len_base - 1;
+}
+
+uint32_t DistCode( uint32_t dist )
+{
+  return std::upper_bound( dist_base, dist_base + 30, dist ) - dist_base - 1;
+}
+
+// Determine the Huffman code lengths for the given symbol frequencies such
+// that no code is longer than max_len. At least two codes are always made,
+// as a single code does not form a complete prefix code.
+void CodeLengths(
+  std::vector< uint32_t > freq, uint32_t max_len, std::vector< uint8_t >& lens
+)
+{
+  uint32_t n = freq.size();
+  uint32_t used = 0;
+  for ( auto f : freq ) used += (f > 0) ? 1 : 0;
+  for ( uint32_t i = 0; used < 2 && i < n; ++i ) {
+    if ( freq[ i ] == 0 ) {
+      freq[ i ] = 1;
+      ++used;
+    }
+  }
+
+  lens.assign( n, 0 );
+  using node_t = std::pair< uint64_t, uint32_t >;
+  std::vector< uint32_t > parent( 2 * n );
+  std::vector< uint32_t > depth( 2 * n );
+  while ( true ) {
+    std::priority_queue<
+      node_t, std::vector< node_t >, std::greater< node_t >
+    > pq;
+    for ( uint32_t i = 0; i < n; ++i ) {
+      if ( freq[ i ] > 0 ) pq.push( { freq[ i ], i } );
+    }
+    uint32_t next = n;
+    while ( pq.size() > 1 ) {
+      node_t a = pq.top(); pq.pop();
+      node_t b = pq.top(); pq.pop();
+      parent[ a.second ] = next;
+      parent[ b.second ] = next;
+      pq.push( { a.first + b.first, next++ } );
+    }
+
+    // Parents are always created after their children, so the depths can be
+    // determined top down by descending node number.
+    uint32_t root = next - 1;
+    uint32_t max_depth = 0;
+    depth[ root ] = 0;
+    for ( uint32_t i = root; i-- > 0; ) {
+      if ( i < n && freq[ i ] == 0 ) continue;
+      depth[ i ] = depth[ parent[ i ] ] + 1;
+      if ( i < n ) {
+        lens[ i ] = depth[ i ];
+        max_depth = std::max( max_depth, depth[ i ] );
+      }
+    }
+    if ( max_depth <= max_len ) break;
+
+    // Flatten the frequency distribution and try again.
+    for ( auto& f : freq ) {
+      if ( f > 0 ) f = (f >> 1) | 1;
+    }
+  }
+}
+
+// Determine the canonical Huffman codes from the code lengths; the codes are
+// bit reversed as Huffman codes are sent most significant bit first.
+void CanonicalCodes(
+  const std::vector< uint8_t >& lens, std::vector< uint16_t >& codes
+)
+{
+  uint32_t bl_count[ 16 ] = {};
+  for ( auto l : lens ) bl_count[ l ]++;
+  bl_count[ 0 ] = 0;
+  uint32_t next_code[ 16 ];
+  uint32_t code = 0;
+  for ( uint32_t bits = 1; bits < 16; ++bits ) {
+    code = (code + bl_count[ bits - 1 ]) << 1;
+    next_code[ bits ] = code;
+  }
+  codes.assign( lens.size(), 0 );
+  for ( size_t i = 0; i < lens.size(); ++i ) {
+    uint32_t len = lens[ i ];
+    if ( len == 0 ) continue;
+    uint32_t c = next_code[ len ]++;
+    uint32_t r = 0;
+    for ( uint32_t b = 0; b < len; ++b ) {
+      r = (r << 1) | (c & 1);
+      c >>= 1;
+    }
+    codes[ i ] = r;
+  }
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+GzipBuf::GzipBuf( std::ostream& os )
+  : os( os )
+{
+  head.assign( size_t( 1 ) << hash_bits, -1 );
+  prev.assign( window_size, -1 );
+
+  // Gzip header: ID1, ID2, CM=deflate, FLG, MTIME, XFL, OS=unknown.
+  out = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF };
+  FlushBits();
+}
+
+GzipBuf::~GzipBuf( void )
+{
+  Finish();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+GzipBuf::int_type GzipBuf::overflow( int_type ch )
+{
+  if ( traits_type::eq_int_type( ch, traits_type::eof() ) ) {
+    return traits_type::not_eof( ch );
+  }
+  char c = traits_type::to_char_type( ch );
+  return (xsputn( &c, 1 ) == 1) ? ch : traits_type::eof();
+}
+
+std::streamsize GzipBuf::xsputn( const char* s, std::streamsize n )
+{
+  if ( finished ) return 0;
+
+  std::streamsize left = n;
+  while ( left > 0 ) {
+    // Take in at most a block at a time to bound the memory usage.
+    size_t cnt = std::min( left, std::streamsize( block_size ) );
+    for ( size_t i = 0; i < cnt; ++i ) {
+      uint8_t b = s[ i ];
+      crc = crc_table[ (crc ^ b) & 0xFF ] ^ (crc >> 8);
+    }
+    buf.insert( buf.end(), s, s + cnt );
+    total += cnt;
+    s += cnt;
+    left -= cnt;
+    while ( buf_pos + int64_t( buf.size() ) - done >= block_size + max_match ) {
+      Compress( done + block_size, false );
+    }
+  }
+
+  return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GzipBuf::Finish( void )
+{
+  if ( finished ) return;
+  Compress( buf_pos + buf.size(), true );
+  FlushBits( true );
+  uint32_t c = crc ^ 0xFFFFFFFF;
+  uint32_t t = total & 0xFFFFFFFF;
+  for ( int i = 0; i < 4; ++i ) out.push_back( (c >> (8 * i)) & 0xFF );
+  for ( int i = 0; i < 4; ++i ) out.push_back( (t >> (8 * i)) & 0xFF );
+  FlushBits();
+  os.flush();
+  buf.clear();
+  finished = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GzipBuf::PutBits( uint32_t bits, uint32_t n )
+{
+  bit_buf |= uint64_t( bits ) << bit_cnt;
+  bit_cnt += n;
+  while ( bit_cnt >= 8 ) {
+    out.push_back( bit_buf & 0xFF );
+    bit_buf >>= 8;
+    bit_cnt -= 8;
+  }
+}
+
+void GzipBuf::FlushBits( bool align )
+{
+  if ( align && bit_cnt > 0 ) {
+    out.push_back( bit_buf & 0xFF );
+    bit_buf = 0;
+    bit_cnt = 0;
+  }
+  os.write( reinterpret_cast< const char* >( out.data() ), out.size() );
+  out.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GzipBuf::Compress( int64_t end, bool final )
+{
+  FindTokens( end );
+  WriteBlock( final );
+  FlushBits();
+
+  // Retain a window of already compressed data for future matches.
+  int64_t keep = done - window_size;
+  if ( keep > buf_pos ) {
+    buf.erase( buf.begin(), buf.begin() + (keep - buf_pos) );
+    buf_pos = keep;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GzipBuf::InsertHash( int64_t pos )
+{
+  if ( pos + min_match > buf_pos + int64_t( buf.size() ) ) return;
+  const uint8_t* p = &buf[ pos - buf_pos ];
+  uint32_t v = p[ 0 ] | (p[ 1 ] << 8) | (p[ 2 ] << 16);
+  uint32_t h = (v * 2654435761u) >> (32 - hash_bits);
+  prev[ pos & (window_size - 1) ] = head[ h ];
+  head[ h ] = pos;
+}
+
+// Greedy LZ77 matching using hash chains. A match may extend beyond end, in
+// which case the next block starts after the match.
+void GzipBuf::FindTokens( int64_t end )
+{
+  int64_t buf_end = buf_pos + buf.size();
+  int64_t pos = done;
+  while ( pos < end ) {
+    const uint8_t* p = &buf[ pos - buf_pos ];
+    uint32_t avail = std::min( int64_t( max_match ), buf_end - pos );
+    uint32_t best_len = 0;
+    uint32_t best_dist = 0;
+    if ( avail >= min_match ) {
+      uint32_t v = p[ 0 ] | (p[ 1 ] << 8) | (p[ 2 ] << 16);
+      int64_t cand = head[ (v * 2654435761u) >> (32 - hash_bits) ];
+      uint32_t chain = max_chain;
+      while (
+        cand >= buf_pos && pos - cand <= window_size && chain-- > 0
+      ) {
+        const uint8_t* q = &buf[ cand - buf_pos ];
+        if ( q[ best_len ] == p[ best_len ] ) {
+          uint32_t len = 0;
+          while ( len < avail && q[ len ] == p[ len ] ) ++len;
+          if ( len > best_len ) {
+            best_len = len;
+            best_dist = pos - cand;
+            if ( len == avail ) break;
+          }
+        }
+        int64_t next = prev[ cand & (window_size - 1) ];
+        if ( next >= cand ) break;
+        cand = next;
+      }
+    }
+    // A short match far away does not pay off.
+    if ( best_len == min_match && best_dist > 4096 ) best_len = 0;
+    if ( best_len >= min_match ) {
+      tokens.push_back( { uint16_t( best_len ), uint16_t( best_dist ) } );
+      for ( uint32_t i = 0; i < best_len; ++i ) InsertHash( pos + i );
+      pos += best_len;
+    } else {
+      tokens.push_back( { p[ 0 ], 0 } );
+      InsertHash( pos );
+      pos++;
+    }
+  }
+  done = pos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Write the tokens as a block compressed with dynamic Huffman codes.
+void GzipBuf::WriteBlock( bool final )
+{
+  std::vector< uint32_t > ll_freq( 286, 0 );
+  std::vector< uint32_t > d_freq( 30, 0 );
+  for ( const token_t& t : tokens ) {
+    if ( t.dist == 0 ) {
+      ll_freq[ t.len ]++;
+    } else {
+      ll_freq[ 257 + LenCode( t.len ) ]++;
+      d_freq[ DistCode( t.dist ) ]++;
+    }
+  }
+  ll_freq[ 256 ] = 1;
+
+  std::vector< uint8_t > ll_len;
+  std::vector< uint8_t > d_len;
+  CodeLengths( ll_freq, 15, ll_len );
+  CodeLengths( d_freq, 15, d_len );
+
+  uint32_t hlit = 286;
+  while ( hlit > 257 && ll_len[ hlit - 1 ] == 0 ) --hlit;
+  uint32_t hdist = 30;
+  while ( hdist > 1 && d_len[ hdist - 1 ] == 0 ) --hdist;
+
+  // Run length encode the code lengths of both alphabets.
+  std::vector< uint8_t > all( ll_len.begin(), ll_len.begin() + hlit );
+  all.insert( all.end(), d_len.begin(), d_len.begin() + hdist );
+  struct cl_t {
+    uint8_t sym;
+    uint8_t extra;
+  };
+  std::vector< cl_t > cl_list;
+  for ( size_t i = 0; i < all.size(); ) {
+    uint8_t l = all[ i ];
+    size_t run = 1;
+    while ( i + run < all.size() && all[ i + run ] == l ) ++run;
+    if ( l == 0 && run >= 3 ) {
+      size_t r = std::min( run, size_t( 138 ) );
+      if ( r >= 11 ) {
+        cl_list.push_back( { 18, uint8_t( r - 11 ) } );
+      } else {
+        cl_list.push_back( { 17, uint8_t( r - 3 ) } );
+      }
+      i += r;
+    } else
+    if ( l != 0 && run >= 4 ) {
+      size_t r = std::min( run - 1, size_t( 6 ) );
+      cl_list.push_back( { l, 0 } );
+      cl_list.push_back( { 16, uint8_t( r - 3 ) } );
+      i += 1 + r;
+    } else {
+      cl_list.push_back( { l, 0 } );
+      i += 1;
+    }
+  }
+
+  std::vector< uint32_t > cl_freq( 19, 0 );
+  for ( const cl_t& c : cl_list ) cl_freq[ c.sym ]++;
+  std::vector< uint8_t > cl_len;
+  std::vector< uint16_t > cl_code;
+  CodeLengths( cl_freq, 7, cl_len );
+  CanonicalCodes( cl_len, cl_code );
+  uint32_t hclen = 19;
+  while ( hclen > 4 && cl_len[ cl_order[ hclen - 1 ] ] == 0 ) --hclen;
+
+  PutBits( final ? 1 : 0, 1 );
+  PutBits( 2, 2 );
+  PutBits( hlit - 257, 5 );
+  PutBits( hdist - 1, 5 );
+  PutBits( hclen - 4, 4 );
+  for ( uint32_t i = 0; i < hclen; ++i ) {
+    PutBits( cl_len[ cl_order[ i ] ], 3 );
+  }
+  for ( const cl_t& c : cl_list ) {
+    PutBits( cl_code[ c.sym ], cl_len[ c.sym ] );
+    if ( c.sym == 16 ) PutBits( c.extra, 2 );
+    if ( c.sym == 17 ) PutBits( c.extra, 3 );
+    if ( c.sym == 18 ) PutBits( c.extra, 7 );
+  }
+
+  std::vector< uint16_t > ll_code;
+  std::vector< uint16_t > d_code;
+  CanonicalCodes( ll_len, ll_code );
+  CanonicalCodes( d_len, d_code );
+  for ( const token_t& t : tokens ) {
+    if ( t.dist == 0 ) {
+      PutBits( ll_code[ t.len ], ll_len[ t.len ] );
+    } else {
+      uint32_t lc = LenCode( t.len );
+      PutBits( ll_code[ 257 + lc ], ll_len[ 257 + lc ] );
+      PutBits( t.len - len_base[ lc ], len_extra[ lc ] );
+      uint32_t dc = DistCode( t.dist );
+      PutBits( d_code[ dc ], d_len[ dc ] );
+      PutBits( t.dist - dist_base[ dc ], dist_extra[ dc ] );
+    }
+  }
+  PutBits( ll_code[ 256 ], ll_len[ 256 ] );
+
+  tokens.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,96 @@
+//
+//  MIT No Attribution License
+//
+//  Copyright 2024, Soren Kragh
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the
+//  “Software”), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+namespace Chart {
+
+// Stream buffer that gzip compresses (RFC 1951/1952) all data written to it
+// and writes the compressed data to another stream. The data is compressed
+// incrementally in blocks, so only a small part of the uncompressed data is
+// held in memory at any time. Typical use:
+//
+//   GzipBuf gz( file );
+//   std::ostream os( &gz );
+//   os << ...;
+//   gz.Finish();
+//
+class GzipBuf : public std::streambuf
+{
+public:
+
+  GzipBuf( std::ostream& os );
+  ~GzipBuf( void );
+
+  // Compress any remaining data and write the gzip trailer; no more data can
+  // be written after this. Called by the destructor if not called explicitly.
+  void Finish( void );
+
+protected:
+
+  int_type overflow( int_type ch ) override;
+  std::streamsize xsputn( const char* s, std::streamsize n ) override;
+
+private:
+
+  static constexpr uint32_t window_size = 32768;
+  static constexpr uint32_t block_size  = 65536;
+  static constexpr uint32_t min_match   = 3;
+  static constexpr uint32_t max_match   = 258;
+  static constexpr uint32_t max_chain   = 128;
+  static constexpr uint32_t hash_bits   = 15;
+
+  std::ostream& os;
+  bool finished = false;
+
+  uint32_t crc = 0xFFFFFFFF;
+  uint64_t total = 0;
+
+  // Uncompressed data; buf[ 0 ] is at stream position buf_pos, and all data
+  // before stream position done has been compressed.
+  std::vector< uint8_t > buf;
+  int64_t buf_pos = 0;
+  int64_t done = 0;
+
+  // Hash chains of previous stream positions used to find matches.
+  std::vector< int64_t > head;
+  std::vector< int64_t > prev;
+
+  // A literal (dist=0, len=literal) or a match.
+  struct token_t {
+    uint16_t len;
+    uint16_t dist;
+  };
+  std::vector< token_t > tokens;
+
+  uint64_t bit_buf = 0;
+  uint32_t bit_cnt = 0;
+  std::vector< uint8_t > out;
+
+  void PutBits( uint32_t bits, uint32_t n );
+  void FlushBits( bool align = false );
+
+  // Compress the pending data up to (at least) the given stream position.
+  void Compress( int64_t end, bool final );
+
+  void InsertHash( int64_t pos );
+  void FindTokens( int64_t end );
+  void WriteBlock( bool final );
+};
+
+}
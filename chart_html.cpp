@@ -14,6 +14,9 @@
 #include <chart_ensemble.h>
 #include <chart_html.h>
 
+#include <cstring>
+#include <unordered_map>
+
 using namespace SVG;
 using namespace Chart;
 
@@ -64,11 +67,13 @@ void HTML::DefAxisY(
 
 void HTML::LegendPos( Series* series, const SVG::BoundaryBox& bb )
 {
+  std::lock_guard< std::mutex > lock( series_legend_mutex );
   series_legend_map[ series ] = bb;
 }
 
 void HTML::MoveLegend( Series* series, SVG::U dx, SVG::U dy )
 {
+  std::lock_guard< std::mutex > lock( series_legend_mutex );
   for ( Series* s = series; s != nullptr; s = s->same_legend_series ) {
     auto it = series_legend_map.find( s );
     if ( it != series_legend_map.end() ) {
@@ -94,9 +99,7 @@ void HTML::AddSnapPoint(
   SVG::Point p, std::string_view tag_x, std::string_view tag_y
 )
 {
-  series->main->html.snap_points.push_back(
-    { series->id, 0, p, tag_x, tag_y }
-  );
+  series->snap_points.push_back( { series->id, 0, p, tag_x, tag_y } );
   series->has_snap = true;
 }
 
@@ -105,15 +108,13 @@ void HTML::AddSnapPoint(
   SVG::Point p, uint32_t cat_idx, std::string_view tag_y
 )
 {
-  series->main->html.snap_points.push_back(
-    { series->id, cat_idx, p, "", tag_y }
-  );
+  series->snap_points.push_back( { series->id, cat_idx, p, "", tag_y } );
   series->has_snap = true;
 }
 
-void HTML::DontPruneSnapPoint( SVG::Point p )
+void HTML::DontPruneSnapPoint( Series* series, SVG::Point p )
 {
-  dont_prune_set.insert( p );
+  series->dont_prune_points.push_back( p );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -136,9 +137,44 @@ std::string quoteJS( std::string_view s ) {
   return oss.str();
 }
 
+std::string base64JS( const std::vector< uint8_t >& data ) {
+  static const char* digits =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string s;
+  s.reserve( (data.size() + 2) / 3 * 4 + 2 );
+  s += '"';
+  size_t i = 0;
+  for ( ; i + 2 < data.size(); i += 3 ) {
+    uint32_t v = (data[ i ] << 16) | (data[ i + 1 ] << 8) | data[ i + 2 ];
+    s += digits[ (v >> 18) & 0x3F ];
+    s += digits[ (v >> 12) & 0x3F ];
+    s += digits[ (v >>  6) & 0x3F ];
+    s += digits[ (v >>  0) & 0x3F ];
+  }
+  if ( i < data.size() ) {
+    uint32_t v = data[ i ] << 16;
+    if ( i + 1 < data.size() ) v |= data[ i + 1 ] << 8;
+    s += digits[ (v >> 18) & 0x3F ];
+    s += digits[ (v >> 12) & 0x3F ];
+    s += (i + 1 < data.size()) ? digits[ (v >> 6) & 0x3F ] : '=';
+    s += '=';
+  }
+  s += '"';
+  return s;
+}
+
+// Append the value in little-endian byte order.
+template < typename T >
+void appendLE( std::vector< uint8_t >& data, T v ) {
+  uint32_t u;
+  static_assert( sizeof( T ) == sizeof( u ) );
+  std::memcpy( &u, &v, sizeof( u ) );
+  for ( int i = 0; i < 4; ++i ) data.push_back( (u >> (8 * i)) & 0xFF );
+}
+
 //------------------------------------------------------------------------------
 
-void HTML::GenChartData( Main* main, std::ostringstream& oss )
+void HTML::GenChartData( Main* main, std::ostream& oss )
 {
   BoundaryBox chart_bb = main->GetGroup()->GetBB();
 
@@ -387,7 +423,7 @@ void HTML::GenChartData( Main* main, std::ostringstream& oss )
       it = base_it;
       while ( it != main->html.snap_points.end() && it->series_id == id ) {
         bool added = SnapAdd( it->p );
-        bool dont_prune = dont_prune_set.count( it->p ) > 0;
+        bool dont_prune = main->html.dont_prune_set.count( it->p ) > 0;
         if ( added || dont_prune ) {
           cat_set.insert( it->cat_idx );
         }
@@ -408,7 +444,7 @@ void HTML::GenChartData( Main* main, std::ostringstream& oss )
     }
   }
 
-  oss << "snapPoints : [\n";
+  std::vector< const Main::html_t::snap_point_t* > snap_list;
   for (
     auto it = main->html.snap_points.rbegin();
     it != main->html.snap_points.rend(); ++it
@@ -420,21 +456,59 @@ void HTML::GenChartData( Main* main, std::ostringstream& oss )
     } else {
       add = add || SnapAdd( sp.p );
     }
-    if ( add ) {
-      U X = +(sp.p.x + main->g_dx);
-      U Y = -(sp.p.y + main->g_dy);
-      oss << "{s:" << sp.series_id << ',';
-      if ( sp.tag_x.empty() ) {
-        oss << "x:" << sp.cat_idx << ',';
+    if ( add ) snap_list.push_back( &sp );
+  }
+
+  if ( binary_snaps ) {
+    std::vector< uint8_t > s_data;
+    std::vector< uint8_t > x_data;
+    std::vector< uint8_t > y_data;
+    std::vector< uint8_t > p_data;
+    std::vector< std::string_view > str_list;
+    std::unordered_map< std::string_view, uint32_t > str_map;
+    auto str_idx = [&]( std::string_view s ) {
+      auto ins = str_map.emplace( s, str_list.size() );
+      if ( ins.second ) str_list.push_back( s );
+      return ins.first->second;
+    };
+    for ( auto sp : snap_list ) {
+      appendLE( s_data, uint32_t( sp->series_id ) );
+      if ( sp->tag_x.empty() ) {
+        appendLE( x_data, int32_t( sp->cat_idx ) );
       } else {
-        oss << "x:" << quoteJS( sp.tag_x ) << ',';
+        appendLE( x_data, int32_t( -1 - str_idx( sp->tag_x ) ) );
       }
-      oss << "y:" << quoteJS( sp.tag_y ) << ",";
+      appendLE( y_data, uint32_t( str_idx( sp->tag_y ) ) );
+      appendLE( p_data, float( +(sp->p.x + main->g_dx) ) );
+      appendLE( p_data, float( -(sp->p.y + main->g_dy) ) );
+    }
+    oss << "snapData : {\n";
+    oss << "n:" << snap_list.size() << ",\n";
+    oss << "s:" << base64JS( s_data ) << ",\n";
+    oss << "x:" << base64JS( x_data ) << ",\n";
+    oss << "y:" << base64JS( y_data ) << ",\n";
+    oss << "p:" << base64JS( p_data ) << ",\n";
+    oss << "t:[\n";
+    for ( auto s : str_list ) oss << quoteJS( s ) << ",\n";
+    oss << "],\n";
+    oss << "},\n";
+  } else {
+    oss << "snapPoints : [\n";
+    for ( auto sp : snap_list ) {
+      U X = +(sp->p.x + main->g_dx);
+      U Y = -(sp->p.y + main->g_dy);
+      oss << "{s:" << sp->series_id << ',';
+      if ( sp->tag_x.empty() ) {
+        oss << "x:" << sp->cat_idx << ',';
+      } else {
+        oss << "x:" << quoteJS( sp->tag_x ) << ',';
+      }
+      oss << "y:" << quoteJS( sp->tag_y ) << ",";
       oss << "X:" << X.SVG( false ) << ',';
       oss << "Y:" << Y.SVG( false ) << "},\n";
     }
+    oss << "],\n";
   }
-  oss << "],\n";
 
   if ( !main->category_list.empty() ) {
     oss << "catCnt : " << main->category_list.size() << ",\n";
@@ -462,9 +536,13 @@ void HTML::GenChartData( Main* main, std::ostringstream& oss )
 
 //------------------------------------------------------------------------------
 
-std::string HTML::GenHTML( SVG::Canvas* canvas )
+void HTML::GenHTML( SVG::Canvas* canvas, std::ostream& oss )
 {
-  std::ostringstream oss;
+  // The stream belongs to the caller, so restore its format when done.
+  std::ios_base::fmtflags old_flags = oss.flags();
+  std::streamsize old_precision = oss.precision();
+  oss.flags( std::ios_base::dec | std::ios_base::skipws );
+  oss.precision( 6 );
   oss << std::boolalpha;
 
   #include <chart_html_part1.h>
@@ -480,7 +558,17 @@ std::string HTML::GenHTML( SVG::Canvas* canvas )
     oss << "position:relative;margin:0 auto;\">\n";
   }
 
-  oss << canvas->GenSVG( 0, "style=\"pointer-events: none;\" id=\"svgChart\"" );
+  {
+    Stats* stats = &ensemble->stats;
+    std::string svg;
+    {
+      Stats::Timer timer( stats, "GenSVG" );
+      svg =
+        canvas->GenSVG( 0, "style=\"pointer-events: none;\" id=\"svgChart\"" );
+    }
+    stats->objects = Stats::CountElements( svg );
+    oss << svg;
+  }
 
   {
     Canvas cursor_canvas;
@@ -508,13 +596,15 @@ std::string HTML::GenHTML( SVG::Canvas* canvas )
 
   oss << "const chart_list = [" << '\n';
   for ( auto main : main_list ) {
+    Stats::Timer timer( &ensemble->stats, "GenChartData", main->id );
     GenChartData( main, oss );
   }
   oss << "];" << '\n';
 
   #include <chart_html_part2.h>
 
-  return oss.str();
+  oss.flags( old_flags );
+  oss.precision( old_precision );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -14,6 +14,8 @@
 #pragma once
 
 #include <map>
+#include <mutex>
+#include <ostream>
 #include <chart_common.h>
 
 #include <unordered_set>
@@ -48,6 +50,8 @@ public:
   void MoveLegend( Series* series, SVG::U dx, SVG::U dy );
   void MoveLegends( Main* main, SVG::U dx, SVG::U dy );
 
+  // The snap points are collected in the series, which may be built
+  // concurrently, and are merged into the chart by Main::BuildSeries().
   void AddSnapPoint(
     Series* series,
     SVG::Point p, std::string_view tag_x, std::string_view tag_y
@@ -58,16 +62,33 @@ public:
   );
 
   // Instruct that given point cannot be pruned.
-  void DontPruneSnapPoint( SVG::Point p );
+  void DontPruneSnapPoint( Series* series, SVG::Point p );
 
-  std::string GenHTML( SVG::Canvas* canvas );
+  // Write the HTML document to the given stream.
+  void GenHTML( SVG::Canvas* canvas, std::ostream& oss );
 
   Ensemble* ensemble = nullptr;
   std::vector< Main* > main_list;
 
-  void GenChartData( Main* main, std::ostringstream& oss );
+  void GenChartData( Main* main, std::ostream& oss );
 
+  // Encode the snap points as base64 binary arrays with the tags in a string
+  // table instead of as a list of JavaScript objects. This makes large HTML
+  // pages smaller and much faster to load.
+  bool binary_snaps = false;
+
+  // Charts may be built concurrently, so the legend map is protected by a
+  // mutex.
   std::map< Series*, SVG::BoundaryBox > series_legend_map;
+  std::mutex series_legend_mutex;
+
+  struct snap_point_t {
+    uint32_t series_id;
+    uint32_t cat_idx;
+    SVG::Point p;
+    std::string_view tag_x;
+    std::string_view tag_y;
+  };
 
   struct PointHash {
     size_t operator()( const SVG::Point& p ) const {
@@ -82,8 +103,6 @@ public:
       return a.x == b.x && a.y == b.y;
     }
   };
-
-  std::unordered_set< SVG::Point, PointHash, PointEqual > dont_prune_set;
 };
 
 }
@@ -112,6 +112,37 @@ function snapMapGet(snapMap, x, y) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Decode base64 encoded little-endian binary data into a typed array.
+function decodeBase64(s, type) {
+  const bin = atob(s);
+  const bytes = new Uint8Array(bin.length);
+  for (let i = 0; i < bin.length; i++) {
+    bytes[i] = bin.charCodeAt(i);
+  }
+  return new type(bytes.buffer);
+}
+
+// Build the list of snap points from the binary encoded snap point data.
+function decodeSnapPoints(data) {
+  const s = decodeBase64(data.s, Uint32Array);
+  const x = decodeBase64(data.x, Int32Array);
+  const y = decodeBase64(data.y, Uint32Array);
+  const p = decodeBase64(data.p, Float32Array);
+  const snapPoints = new Array(data.n);
+  for (let i = 0; i < data.n; i++) {
+    snapPoints[i] = {
+      s : s[i],
+      x : (x[i] < 0) ? data.t[-1 - x[i]] : x[i],
+      y : data.t[y[i]],
+      X : p[2 * i],
+      Y : p[2 * i + 1]
+    };
+  }
+  return snapPoints;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 function getLinAxisValue(x0, x1, x2, v1, v2) {
   if (x1 === x2) return NaN;
   const t = (x0 - x1) / (x2 - x1);
@@ -938,6 +969,10 @@ svg_snap.addEventListener("mouseleave", () => {
   chart_list.forEach(c => {
     chart = c;
 
+    if (chart.snapData) {
+      chart.snapPoints = decodeSnapPoints(chart.snapData);
+    }
+
     chart.axisX[0].id = "axisX_0";
     chart.axisX[1].id = "axisX_1";
     chart.axisY[0].id = "axisY_0";
@@ -13,13 +13,16 @@
 
 #include <chart_label.h>
 
+#include <algorithm>
+
 using namespace SVG;
 using namespace Chart;
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Label::Label( void )
+Label::Label( TextCache* text_cache )
 {
+  this->text_cache = text_cache;
 }
 
 Label::~Label( void )
@@ -29,10 +32,11 @@ Label::~Label( void )
 ////////////////////////////////////////////////////////////////////////////////
 
 SVG::Group* Label::CreateInDB(
-  SVG::Group* g, const std::string& txt, SVG::U size, bool append
+  SVG::Group* g, const std::string& txt, SVG::U size, bool append,
+  const TextCache::font_t* font
 )
 {
-  return Label::Create( this, g, txt, size, append );
+  return Label::Create( this, g, txt, size, append, font );
 }
 
 //------------------------------------------------------------------------------
@@ -51,7 +55,7 @@ SVG::Group* Label::CreateLabel(
 SVG::Group* Label::Create(
   Label* label_db,
   SVG::Group* g, const std::string& txt, SVG::U size,
-  bool append
+  bool append, const TextCache::font_t* font
 )
 {
   U y = 0;
@@ -120,7 +124,20 @@ SVG::Group* Label::Create(
   if ( label_db ) {
     Container c;
     c.link = e.link;
-    c.bb = g->GetBB();
+    // A new container with a single line holds just one text object placed
+    // at (0,0).
+    if (
+      font && label_db->text_cache && !append &&
+      txt.find( '\n' ) == std::string::npos
+    ) {
+      c.bb =
+        label_db->text_cache->GetBB(
+          *font, txt, [&]( void ) { return g->GetBB(); }
+        );
+    } else {
+      c.bb = g->GetBB();
+    }
+    c.seq = label_db->container_seq++;
     label_db->containers[ g ] = c;
   }
   return g;
@@ -151,7 +168,17 @@ void Label::AddBackground(
   SVG::Group* bg_g, const SVG::BoundaryBox& area, bool partial_ok
 )
 {
+  // Visit the containers in creation order, as the order of the hash map
+  // depends on the memory layout.
+  std::vector< std::pair< uint64_t, SVG::Group* > > order;
+  order.reserve( containers.size() );
   for ( const auto& [container, c] : containers ) {
+    order.emplace_back( c.seq, container );
+  }
+  std::sort( order.begin(), order.end() );
+
+  for ( const auto& [seq, container] : order ) {
+    const Container& c = containers[ container ];
     BoundaryBox bb = container->GetBB();
     U dx = bb.min.x - c.bb.min.x;
     U dy = bb.min.y - c.bb.min.y;
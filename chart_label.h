@@ -22,9 +22,11 @@ class Label
 {
 public:
 
-  Label( void );
+  Label( TextCache* text_cache );
   ~Label( void );
 
+  TextCache* text_cache;
+
   struct Entry {
     SVG::Object* link;
     SVG::U leading_space;
@@ -34,26 +36,29 @@ public:
   struct Container {
     SVG::Object* link;
     SVG::BoundaryBox bb;
+    uint64_t seq;         // Creation order.
   };
 
   std::unordered_map< SVG::Object*, Entry > entries;
   std::unordered_map< SVG::Group*, Container > containers;
+  uint64_t container_seq = 0;
 
   // Create the given label, which might be multi-line text. Return the created
   // container, which is a group of text objects (one per line). If append is
   // true, then this text is instead appended to the previously created
-  // container given by g.
+  // container given by g. If the font of the text is given, a single line
+  // label is measured through the text cache.
   static SVG::Group* Create(
     Label* label_db,
     SVG::Group* g, const std::string& txt, SVG::U size,
-    bool append
+    bool append, const TextCache::font_t* font = nullptr
   );
   static SVG::Group* CreateLabel(
     SVG::Group* g, const std::string& txt, SVG::U size = 0
   );
   SVG::Group* CreateInDB(
     SVG::Group* g, const std::string& txt, SVG::U size = 0,
-    bool append = false
+    bool append = false, const TextCache::font_t* font = nullptr
   );
 
   // If the text objects inside the container has been moved, then this must be
@@ -13,6 +13,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include <svg_canvas.h>
 
 namespace Chart {
@@ -34,4 +38,70 @@ public:
 
 };
 
+// Uniform grid over the candidate legend boxes, where each cell lists the
+// legend boxes overlapping the cell. This is used to find the few legend boxes
+// that a line segment may hit without visiting all the candidate legend boxes
+// for every segment of every series.
+class LegendBoxIndex
+{
+public:
+
+  void Build( const std::vector< LegendBox >& lb_list )
+  {
+    cell_list.clear();
+    if ( lb_list.empty() ) return;
+    area = SVG::BoundaryBox();
+    for ( const LegendBox& lb : lb_list ) {
+      area.Update( lb.bb.min );
+      area.Update( lb.bb.max );
+    }
+    cell_w = (area.max.x - area.min.x) / grid_n;
+    cell_h = (area.max.y - area.min.y) / grid_n;
+    cell_list.resize( grid_n * grid_n );
+    for ( uint32_t i = 0; i < lb_list.size(); ++i ) {
+      const SVG::BoundaryBox& bb = lb_list[ i ].bb;
+      for ( uint32_t y = CellY( bb.min.y ); y <= CellY( bb.max.y ); ++y ) {
+        for ( uint32_t x = CellX( bb.min.x ); x <= CellX( bb.max.x ); ++x ) {
+          cell_list[ y * grid_n + x ].push_back( i );
+        }
+      }
+    }
+  }
+
+  // Return the indices of the legend boxes that may overlap the bounding box
+  // of the given points, or nullptr if all legend boxes must be checked; this
+  // is the case if the bounding box spans more than one cell.
+  const std::vector< uint32_t >* Lookup(
+    SVG::Point p1, SVG::Point p2
+  ) const
+  {
+    if ( cell_list.empty() ) return nullptr;
+    uint32_t x = CellX( p1.x );
+    uint32_t y = CellY( p1.y );
+    if ( x != CellX( p2.x ) || y != CellY( p2.y ) ) return nullptr;
+    return &cell_list[ y * grid_n + x ];
+  }
+
+private:
+
+  static constexpr uint32_t grid_n = 16;
+
+  // The cell of a coordinate; coordinates outside the grid belong to the
+  // nearest cell. Since this is monotonic, a legend box is listed in every
+  // cell containing a point of the legend box.
+  uint32_t Cell( SVG::U v, SVG::U v0, SVG::U w ) const
+  {
+    if ( !(w > 0) ) return 0;
+    double c = std::floor( (v - v0) / w );
+    return static_cast< uint32_t >( std::clamp( c, 0.0, grid_n - 1.0 ) );
+  }
+  uint32_t CellX( SVG::U x ) const { return Cell( x, area.min.x, cell_w ); }
+  uint32_t CellY( SVG::U y ) const { return Cell( y, area.min.y, cell_h ); }
+
+  SVG::BoundaryBox area;
+  SVG::U cell_w = 0;
+  SVG::U cell_h = 0;
+  std::vector< std::vector< uint32_t > > cell_list;
+};
+
 }
@@ -21,7 +21,7 @@ using namespace Chart;
 
 Main::Main( Ensemble* ensemble, SVG::Group* svg_g )
 {
-  label_db    = new Label();
+  label_db    = new Label( &ensemble->text_cache );
   legend_obj  = new Legend( ensemble );
   tag_db      = new Tag();
   axis_x      = new Axis( true , label_db );
@@ -167,7 +167,7 @@ void Main::AddCategory( const std::string& category )
 // Determine potential placement of series legends in chart interior.
 void Main::CalcLegendBoxes(
   Group* g, std::vector< LegendBox >& lb_list,
-  const std::vector< SVG::Object* >& avoid_objects
+  const AvoidSet& avoid_objects
 )
 {
   Legend::LegendDims legend_dims;
@@ -208,9 +208,11 @@ void Main::CalcLegendBoxes(
         while ( !done ) {
           done = true;
           BoundaryBox obj_bb = obj->GetBB();
-          for ( auto ao : avoid_objects ) {
-            if ( !SVG::Collides( obj, ao ) ) continue;
-            BoundaryBox ao_bb = ao->GetBB();
+          BoundaryBox cur_bb = obj_bb;
+          for ( size_t i = 0; i < avoid_objects.Size(); ++i ) {
+            if ( !avoid_objects.Near( i, cur_bb ) ) continue;
+            if ( !SVG::Collides( obj, avoid_objects.Obj( i ) ) ) continue;
+            const BoundaryBox& ao_bb = avoid_objects.BB( i );
             U dx =
               (anchor_x == AnchorX::Min)
               ? (ao_bb.max.x - obj_bb.min.x)
@@ -227,6 +229,7 @@ void Main::CalcLegendBoxes(
               dx = 0;
             }
             obj->Move( dx, dy );
+            cur_bb = obj->GetBB();
             if ( std::abs( dx ) > epsilon && std::abs( dy ) > epsilon ) {
               done = false;
               break;
@@ -331,7 +334,7 @@ void Main::CalcLegendBoxes(
 //-----------------------------------------------------------------------------
 
 void Main::PlaceLegends(
-  std::vector< SVG::Object* >& avoid_objects,
+  AvoidSet& avoid_objects,
   const std::vector< LegendBox >& lb_list,
   Group* legend_g
 )
@@ -456,7 +459,7 @@ void Main::PlaceLegends(
       moved_bb.min.x - build_bb.min.x,
       moved_bb.min.y - build_bb.min.y
     );
-    avoid_objects.push_back( legend );
+    avoid_objects.Add( legend );
 
   } else {
 
@@ -512,7 +515,7 @@ void Main::PlaceLegends(
       moved_bb.min.x - build_bb.min.x,
       moved_bb.min.y - build_bb.min.y
     );
-    avoid_objects.push_back( legend );
+    avoid_objects.Add( legend );
 
   }
 
@@ -1010,7 +1013,8 @@ void Main::AxisPrepare( SVG::Group* tag_g )
 ///////////////////////////////////////////////////////////////////////////////
 
 void Main::SeriesPrepare(
-  std::vector< LegendBox >* lb_list
+  std::vector< LegendBox >* lb_list,
+  const LegendBoxIndex* lb_index
 )
 {
   Color tag_bg_color;
@@ -1034,6 +1038,7 @@ void Main::SeriesPrepare(
   uint32_t series_id = 0;
   for ( auto series : series_list ) {
     series->id = series_id++;
+    series->worker = 0;
 
     series->chart_area.min.x = 0;
     series->chart_area.max.x = chart_w;
@@ -1042,6 +1047,7 @@ void Main::SeriesPrepare(
     series->axis_x = axis_x;
     series->axis_y = axis_y[ series->axis_y_n ];
     series->lb_list = lb_list;
+    series->lb_index = lb_index;
     series->tag_db = tag_db;
     if ( ensemble->enable_html ) {
       if ( !series->name.empty() || series->anonymous_snap ) {
@@ -1118,7 +1124,7 @@ void Main::SeriesPrepare(
 
     if ( !series->name.empty() ) {
       if ( series->global_legend ) {
-        ensemble->legend_obj->Add( series );
+        global_legend_list.push_back( series );
       } else {
         legend_obj->Add( series );
       }
@@ -1175,7 +1181,16 @@ void Main::BuildSeries(
   Group* bar_line_g          = below_axes_g->AddNewGroup();
   Group* lollipop_stem_g     = below_axes_g->AddNewGroup();
 
+  // With more than one thread, the series which do not stack and have no tags
+  // are built concurrently after the other series. All the series then record
+  // their legend box weight increments, which are added in series order
+  // afterwards, so that the result is the same as when the series are built
+  // one by one.
+  bool concurrent = threads > 1;
+  std::vector< Series* > concurrent_list;
+
   for ( auto series : series_list ) {
+    series->lb_record = concurrent;
     int y_n = series->axis_y_n;
     if ( series->type == SeriesType::StackedArea ) {
       if ( sa_first[ y_n ] ) {
@@ -1256,11 +1271,54 @@ void Main::BuildSeries(
       series->type == SeriesType::Scatter ||
       series->type == SeriesType::Point
     ) {
-      series->Build(
-        above_axes_g, above_axes_g, nullptr, above_axes_g, tag_g,
-        0, 1
-      );
+      if ( series->tag_enable || !concurrent ) {
+        series->Build(
+          above_axes_g, above_axes_g, nullptr, above_axes_g, tag_g,
+          0, 1
+        );
+      } else {
+        series->BuildGroups(
+          above_axes_g, above_axes_g, nullptr, above_axes_g, tag_g
+        );
+        concurrent_list.push_back( series );
+      }
+    }
+  }
+
+  // The series built concurrently are independent of each other, and their
+  // groups have been added above in series order.
+  ParallelFor(
+    concurrent_list.size(), threads,
+    [&]( size_t i, uint32_t worker )
+    {
+      concurrent_list[ i ]->worker = worker;
+      concurrent_list[ i ]->BuildContent( 0, 1 );
     }
+  );
+  for ( auto series : series_list ) {
+    for ( const Series::lb_inc_t& inc : series->lb_inc_list ) {
+      LegendBox& lb = (*series->lb_list)[ inc.idx ];
+      lb.weight1 += inc.weight1;
+      lb.weight2 += inc.weight2;
+    }
+    series->lb_record = false;
+    series->lb_inc_list.clear();
+    series->lb_inc_list.shrink_to_fit();
+  }
+
+  // The snap points are collected per series, so merge them in series order.
+  for ( auto series : series_list ) {
+    html.snap_points.insert(
+      html.snap_points.end(),
+      series->snap_points.begin(), series->snap_points.end()
+    );
+    html.dont_prune_set.insert(
+      series->dont_prune_points.begin(), series->dont_prune_points.end()
+    );
+    series->snap_points.clear();
+    series->snap_points.shrink_to_fit();
+    series->dont_prune_points.clear();
+    series->dont_prune_points.shrink_to_fit();
   }
 
   return;
@@ -1269,7 +1327,7 @@ void Main::BuildSeries(
 //------------------------------------------------------------------------------
 
 void Main::BuildTitle(
-  std::vector< SVG::Object* >& avoid_objects
+  AvoidSet& avoid_objects
 )
 {
   if ( title.empty() && sub_title.empty() && sub_sub_title.empty() ) return;
@@ -1343,9 +1401,9 @@ void Main::BuildTitle(
   }
 
   y = 0;
-  for ( auto obj : avoid_objects ) {
-    if ( !obj->Empty() ) {
-      y = std::max( y, obj->GetBB().max.y );
+  for ( size_t i = 0; i < avoid_objects.Size(); ++i ) {
+    if ( !avoid_objects.Obj( i )->Empty() ) {
+      y = std::max( y, avoid_objects.BB( i ).max.y );
     }
   }
   y = y - text_g->GetBB().max.y;
@@ -1374,6 +1432,7 @@ void Main::BuildTitle(
     }
     text_g->MoveTo( ax, ay, px, py );
 
+    std::vector< uint32_t > idx_list;
     for ( int pass = 0; pass < 2; pass++ ) {
       if ( ax != AnchorX::Mid ) {
         U old_x = coor_hi;
@@ -1382,9 +1441,11 @@ void Main::BuildTitle(
           if ( bb.min.x == old_x ) break;
           old_x = bb.min.x;
           U dx = 0;
-          for ( auto ao : avoid_objects ) {
+          avoid_objects.Find( bb, mx, 0, idx_list );
+          for ( uint32_t i : idx_list ) {
+            Object* ao = avoid_objects.Obj( i );
             if ( !SVG::Collides( text_g, ao, mx, 0 ) ) continue;
-            BoundaryBox ao_bb = ao->GetBB();
+            const BoundaryBox& ao_bb = avoid_objects.BB( i );
             if ( ax == AnchorX::Min && ao_bb.max.x < (chart_w * 1 / 4) ) {
               dx = ao_bb.max.x - bb.min.x + mx;
               break;
@@ -1409,9 +1470,11 @@ void Main::BuildTitle(
           if ( bb.min.y == old_y ) break;
           old_y = bb.min.y;
           U dy = 0;
-          for ( auto ao : avoid_objects ) {
+          avoid_objects.Find( bb, 0, my, idx_list );
+          for ( uint32_t i : idx_list ) {
+            Object* ao = avoid_objects.Obj( i );
             if ( !SVG::Collides( text_g, ao, 0, my ) ) continue;
-            BoundaryBox ao_bb = ao->GetBB();
+            const BoundaryBox& ao_bb = avoid_objects.BB( i );
             if ( ay == AnchorY::Min && ao_bb.max.y < (chart_h * 1 / 4) ) {
               dy = ao_bb.max.y - bb.min.y + my;
               break;
@@ -1427,7 +1490,7 @@ void Main::BuildTitle(
       }
     }
 
-    avoid_objects.push_back( text_g );
+    avoid_objects.Add( text_g );
   }
 
   return;
@@ -1571,28 +1634,45 @@ void Main::Build( void )
   // This group only has numbers so optimize baseline to ensure vertical
   // centering within boundary box.
   tag_g->Attr()->TextFont()
-    ->SetWidthFactor( 1.0 )
-    ->SetHeightFactor( 0.80 )
-    ->SetBaselineFactor( 0.30 );
+    ->SetWidthFactor( Tag::width_factor )
+    ->SetHeightFactor( Tag::height_factor )
+    ->SetBaselineFactor( Tag::baseline_factor );
 
   legend_g->Attr()->TextFont()->SetSize( 14 * legend_obj->size );
 
   std::vector< LegendBox > lb_list;
+  LegendBoxIndex lb_index;
 
-  SeriesPrepare( &lb_list );
-  AxisPrepare( tag_g );
+  Stats* stats = &ensemble->stats;
 
-  std::vector< SVG::Object* > avoid_objects;
+  {
+    Stats::Timer timer( stats, "SeriesPrepare", id );
+    SeriesPrepare( &lb_list, &lb_index );
+  }
+  {
+    Stats::Timer timer( stats, "AxisPrepare", id );
+    AxisPrepare( tag_g );
+  }
+
+  AvoidSet avoid_objects;
 
   for ( uint32_t phase : {0, 1} ) {
-    axis_x->Build(
-      category_list,
-      phase,
-      avoid_objects,
-      grid_minor_g, grid_major_g, grid_zero_g,
-      axes_line_g, axes_num_g, axes_label_g
-    );
+    {
+      std::string name = "Axis::Build X phase " + std::to_string( phase );
+      Stats::Timer timer( stats, name, id );
+      axis_x->Build(
+        category_list,
+        phase,
+        avoid_objects,
+        grid_minor_g, grid_major_g, grid_zero_g,
+        axes_line_g, axes_num_g, axes_label_g
+      );
+    }
     for ( int i : { 1, 0 } ) {
+      std::string name =
+        "Axis::Build Y" + std::to_string( i ) +
+        " phase " + std::to_string( phase );
+      Stats::Timer timer( stats, name, id );
       std::vector< std::string > empty;
       axis_y[ i ]->Build(
         empty,
@@ -1609,6 +1689,10 @@ void Main::Build( void )
     axes_line_g->Last()->Attr()->FillColor()->Clear();
   }
 
+  // The axes are complete now, but the axis groups may have grown after they
+  // were added to the avoid set by an earlier Axis::Build().
+  avoid_objects.Update();
+
   axis_x->BuildLabel( avoid_objects, axes_label_g );
   for ( auto a : axis_y ) {
     a->BuildLabel( avoid_objects, axes_label_g );
@@ -1618,11 +1702,19 @@ void Main::Build( void )
     BuildTitle( avoid_objects );
   }
 
-  CalcLegendBoxes( legend_g, lb_list, avoid_objects );
-
-  BuildSeries( chartbox_below_axes_g, chartbox_above_axes_g, tag_g );
-
-  PlaceLegends( avoid_objects, lb_list, legend_g );
+  {
+    Stats::Timer timer( stats, "CalcLegendBoxes", id );
+    CalcLegendBoxes( legend_g, lb_list, avoid_objects );
+    lb_index.Build( lb_list );
+  }
+  {
+    Stats::Timer timer( stats, "BuildSeries", id );
+    BuildSeries( chartbox_below_axes_g, chartbox_above_axes_g, tag_g );
+  }
+  {
+    Stats::Timer timer( stats, "PlaceLegends", id );
+    PlaceLegends( avoid_objects, lb_list, legend_g );
+  }
 
   if ( !title_inside ) {
     BuildTitle( avoid_objects );
@@ -1630,7 +1722,8 @@ void Main::Build( void )
 
 /*
   {
-    for ( auto obj : avoid_objects ) {
+    for ( size_t i = 0; i < avoid_objects.Size(); ++i ) {
+      Object* obj = avoid_objects.Obj( i );
       if ( obj->Empty() ) continue;
       BoundaryBox bb = obj->GetBB();
       bb.min.x -= 0.1;
@@ -1648,6 +1741,7 @@ void Main::Build( void )
 
   // Add background for text objects in the Label data base.
   {
+    Stats::Timer timer( stats, "Label::AddBackground", id );
     bool partial_ok = true;
     if ( ChartAreaColor()->IsClear() ) {
       label_bg_g->Attr()->FillColor()->Set( ensemble->BackgroundColor() );
@@ -1662,6 +1756,7 @@ void Main::Build( void )
   }
 
   if ( ensemble->enable_html ) {
+    Stats::Timer timer( stats, "PrepareHTML", id );
     PrepareHTML();
   }
 
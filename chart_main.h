@@ -100,6 +100,14 @@ public:
 
   Ensemble* ensemble = nullptr;
   SVG::Group* svg_g = nullptr;
+
+  // Chart ID within the ensemble; assigned by Ensemble::Build().
+  uint32_t id = 0;
+
+  // Number of threads used to build the series concurrently; assigned by
+  // Ensemble::Build().
+  uint32_t threads = 1;
+
   SVG::U g_dx = 0;
   SVG::U g_dy = 0;
 
@@ -109,10 +117,10 @@ public:
 
   void CalcLegendBoxes(
     SVG::Group* g, std::vector< LegendBox >& lb_list,
-    const std::vector< SVG::Object* >& avoid_objects
+    const AvoidSet& avoid_objects
   );
   void PlaceLegends(
-    std::vector< SVG::Object* >& avoid_objects,
+    AvoidSet& avoid_objects,
     const std::vector< LegendBox >& lb_list,
     SVG::Group* legend_g
   );
@@ -124,7 +132,8 @@ public:
   void AxisPrepare( SVG::Group* tag_g );
 
   void SeriesPrepare(
-    std::vector< LegendBox >* lb_list
+    std::vector< LegendBox >* lb_list,
+    const LegendBoxIndex* lb_index
   );
 
   void BuildSeries(
@@ -134,7 +143,7 @@ public:
   );
 
   void BuildTitle(
-    std::vector< SVG::Object* >& avoid_objects
+    AvoidSet& avoid_objects
   );
 
   // Get the padding around the core chart area required to account for markers
@@ -163,6 +172,10 @@ public:
   uint32_t lol_tot = 0;
 
   Legend* legend_obj;
+
+  // Series with a global legend; these are added to the ensemble legend after
+  // all charts have been built, as the charts may be built concurrently.
+  std::vector< Series* > global_legend_list;
   bool    legend_frame;
   bool    legend_frame_specified;
 
@@ -183,16 +196,15 @@ public:
 
   // Used by HTML class.
   struct html_t {
-    struct snap_point_t {
-      uint32_t series_id;
-      uint32_t cat_idx;
-      SVG::Point p;
-      std::string_view tag_x;
-      std::string_view tag_y;
-    };
+    using snap_point_t = HTML::snap_point_t;
 
     std::vector< snap_point_t > snap_points;
 
+    // Snap points which cannot be pruned.
+    std::unordered_set<
+      SVG::Point, HTML::PointHash, HTML::PointEqual
+    > dont_prune_set;
+
     // Informs if all snap points are in line; for multiple bars per category
     // this will not be the case.
     bool all_inline = true;
@@ -13,6 +13,7 @@
 
 #include <chart_series.h>
 #include <chart_main.h>
+#include <chart_ensemble.h>
 
 #include <unordered_set>
 
@@ -32,6 +33,7 @@ Series::Series( Main* main, SeriesType type )
   base = 0;
   tag_db = nullptr;
   tag_enable = false;
+  tag_budget = 0;
   tag_pos = Pos::Auto;
   tag_size = 1.0;
   tag_box = false;
@@ -258,20 +260,37 @@ void Series::ApplyTagStyle( SVG::Object* obj )
   obj->Attr()->FillColor()->Set( &tag_fill_color );
   obj->Attr()->TextColor()->Set( &tag_text_color );
   obj->Attr()->SetLineWidth( 1 );
-  obj->Attr()->TextFont()->SetSize( 12 * tag_size );
-  obj->Attr()->TextFont()->SetBold();
+  TextCache::font_t font = Tag::Font( tag_size );
+  obj->Attr()->TextFont()->SetSize( font.size );
+  if ( font.bold ) obj->Attr()->TextFont()->SetBold();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void Series::PrunePoly( std::vector< Point >& points, bool no_html )
+void Series::PrunePoly(
+  std::vector< Point >& points, bool no_html, std::vector< bool >* keep
+)
 {
   using PI = std::vector< Point >::const_iterator;
 
-  if ( points.size() > 2 && prune_dist >= 0.001 ) {
+  bool prune_enable = points.size() > 2 && prune_dist >= 0.001;
+  if ( keep ) keep->assign( points.size(), !prune_enable );
+
+  if ( prune_enable ) {
 
     size_t idx = 0;
 
+    // Retain the given point, either by flagging it in keep or by moving it
+    // into the pruned result.
+    auto retain = [&]( PI p )
+    {
+      if ( keep ) {
+        (*keep)[ p - points.cbegin() ] = true;
+      } else {
+        points[ idx++ ] = *p;
+      }
+    };
+
     // p1 and p2 are the start and end points of the collection, which is all
     // points from p1 to p2 both inclusive.
     PI p1;
@@ -375,9 +394,9 @@ void Series::PrunePoly( std::vector< Point >& points, bool no_html )
 
     while ( p != points.cend() ) {
       if ( !prune( p ) ) {
-        points[ idx++ ] = *p1;
-        if ( e1 != p1 ) points[ idx++ ] = *e1;
-        if ( e2 != p2 ) points[ idx++ ] = *e2;
+        retain( p1 );
+        if ( e1 != p1 ) retain( e1 );
+        if ( e2 != p2 ) retain( e2 );
         p1 = e1 = p2;
         p2 = e2 = p;
         d1 = d2 = 0;
@@ -385,16 +404,16 @@ void Series::PrunePoly( std::vector< Point >& points, bool no_html )
       ++p;
     }
 
-    points[ idx++ ] = *p1;
-    if ( e1 != p1 ) points[ idx++ ] = *e1;
-    if ( e2 != p2 ) points[ idx++ ] = *e2;
-    points[ idx++ ] = *p2;
+    retain( p1 );
+    if ( e1 != p1 ) retain( e1 );
+    if ( e2 != p2 ) retain( e2 );
+    retain( p2 );
 
-    points.resize( idx );
+    if ( !keep ) points.resize( idx );
   }
 
-  if ( !no_html && html_db ) {
-    for ( const auto& p : points ) html_db->DontPruneSnapPoint( p );
+  if ( !no_html && !keep && html_db ) {
+    for ( const auto& p : points ) html_db->DontPruneSnapPoint( this, p );
   }
 
   return;
@@ -406,36 +425,63 @@ void Series::PrunePoints( std::vector< Point >& points )
 {
   if ( points.size() > 1 && prune_dist >= 0.001 ) {
 
-    std::unordered_set<
-      SVG::Point, HTML::PointHash, HTML::PointEqual
-    > mandatory;
-
     // Make sure extremes are included; for Scatter plot this does not make
     // sense as the points are totally random.
+    std::vector< bool > mandatory;
     if ( type != SeriesType::Scatter ) {
-      auto pts = points;
-      PrunePoly( pts, true );
-      for ( auto& p : pts ) {
-        mandatory.insert( p );
-      }
+      PrunePoly( points, true, &mandatory );
+    } else {
+      mandatory.assign( points.size(), false );
     }
 
-    std::unordered_set< uint64_t > existing;
+    // Only the first point within each prune_dist sized cell of the chart area
+    // is kept. Occupied cells are normally tracked in a bitmap, but if the
+    // bitmap would be excessively large a hash set is used instead.
     double f = 1.0 / prune_dist;
+    double x0 = std::floor( chart_area.min.x * f );
+    double y0 = std::floor( chart_area.min.y * f );
+    uint64_t w = std::floor( chart_area.max.x * f ) - x0 + 1;
+    uint64_t h = std::floor( chart_area.max.y * f ) - y0 + 1;
+    bool use_bitmap = w * h <= prune_bitmap_max;
+    if ( use_bitmap && prune_bitmap.size() < (w * h + 63) / 64 ) {
+      prune_bitmap.assign( (w * h + 63) / 64, 0 );
+    }
+    std::unordered_set< uint64_t > existing;
+
+    auto cell = [&]( Point p )
+    {
+      double cx = std::clamp( std::floor( p.x * f ) - x0, 0.0, w - 1.0 );
+      double cy = std::clamp( std::floor( p.y * f ) - y0, 0.0, h - 1.0 );
+      return static_cast< uint64_t >( cy ) * w + static_cast< uint64_t >( cx );
+    };
+
     size_t idx = 0;
-    for ( const auto& p : points ) {
-      uint64_t key =
-        (static_cast< uint64_t >( p.y * f ) << 32) |
-        (static_cast< uint64_t >( p.x * f ) <<  0);
-      if ( existing.insert( key ).second || mandatory.count( p ) > 0 ) {
+    for ( size_t i = 0; i < points.size(); ++i ) {
+      Point p = points[ i ];
+      uint64_t c = cell( p );
+      bool added;
+      if ( use_bitmap ) {
+        uint64_t bit = uint64_t( 1 ) << (c % 64);
+        added = (prune_bitmap[ c / 64 ] & bit) == 0;
+        prune_bitmap[ c / 64 ] |= bit;
+      } else {
+        added = existing.insert( c ).second;
+      }
+      if ( added || mandatory[ i ] ) {
         points[ idx++ ] = p;
       }
     }
     points.resize( idx );
+
+    // All occupied cells belong to retained points, so clearing the bitmap
+    // words of those leaves the bitmap empty for the next use.
+    if ( use_bitmap ) {
+      for ( const auto& p : points ) prune_bitmap[ cell( p ) / 64 ] = 0;
+    }
   }
 
   if ( html_db ) {
-    for ( const auto& p : points ) html_db->DontPruneSnapPoint( p );
+    for ( const auto& p : points ) html_db->DontPruneSnapPoint( this, p );
   }
 
   return;
@@ -443,9 +489,52 @@ void Series::PrunePoints( std::vector< Point >& points )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Series::RoundPoints( std::vector< Point >& points )
+{
+  if ( coor_decimals < 0 || points.empty() ) return;
+
+  double scale = std::pow( double( 10 ), coor_decimals );
+  auto rnd = [&]( U v ) { return std::round( v * scale ) / scale; };
+
+  size_t idx = 0;
+  for ( const Point& p : points ) {
+    Point r( rnd( p.x ), rnd( p.y ) );
+    if ( idx > 0 && r.x == points[ idx - 1 ].x && r.y == points[ idx - 1 ].y ) {
+      continue;
+    }
+    points[ idx++ ] = r;
+  }
+  points.resize( idx );
+}
+
+void Series::AddPolylines( Group* g, const std::vector< Point >& points )
+{
+  if ( points.empty() ) return;
+  points_out += points.size();
+  auto it = points.cbegin();
+  uint64_t d = 1;
+  if ( max_poly > 0 ) d = (points.size() + max_poly - 1) / max_poly;
+  uint64_t n = 0;
+  for ( uint64_t i = 1; i <= d; ++i ) {
+    uint64_t m = points.size() * i / d;
+    Poly* poly = new Poly();
+    g->Add( poly );
+    while ( n < m ) {
+      poly->Add( *(it++) );
+      ++n;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void Series::Add( double x, double y )
 {
-  datum_list.emplace_back( x, y );
+  if ( x_implicit && x != X( datum_y.size() ) ) ExplicitX();
+  OwnData();
+  if ( !x_implicit ) owned_x.push_back( x );
+  owned_y.push_back( y );
+  SyncData();
 }
 
 void Series::Add(
@@ -454,7 +543,108 @@ void Series::Add(
   const std::string_view tag_y
 )
 {
-  datum_list.emplace_back( x, y, tag_x, tag_y );
+  if ( !tag_x.empty() || !tag_y.empty() ) {
+    tag_list.push_back( { datum_y.size(), tag_x, tag_y } );
+  }
+  Add( x, y );
+}
+
+void Series::Add( Span< double > x, Span< double > y )
+{
+  size_t n = std::min( x.size(), y.size() );
+  OwnData();
+  ExplicitX();
+  owned_x.insert( owned_x.end(), x.begin(), x.begin() + n );
+  owned_y.insert( owned_y.end(), y.begin(), y.begin() + n );
+  SyncData();
+}
+
+void Series::AddBorrowed(
+  Span< double > x, Span< double > y
+)
+{
+  if ( !datum_y.empty() ) {
+    Add( x, y );
+    return;
+  }
+  size_t n = std::min( x.size(), y.size() );
+  datum_x = x.first( n );
+  datum_y = y.first( n );
+  x_implicit = false;
+  borrowed = true;
+}
+
+void Series::SetImplicitX( double start, double step )
+{
+  if ( !datum_y.empty() ) ExplicitX();
+  x_start = start;
+  x_step = step;
+}
+
+void Series::Add( Span< double > y )
+{
+  OwnData();
+  if ( !x_implicit ) {
+    for ( size_t i = 0; i < y.size(); i++ ) {
+      owned_x.push_back( x_start + (owned_y.size() + i) * x_step );
+    }
+  }
+  owned_y.insert( owned_y.end(), y.begin(), y.end() );
+  SyncData();
+}
+
+void Series::AddBorrowed( Span< double > y )
+{
+  if ( !datum_y.empty() || !x_implicit ) {
+    Add( y );
+    return;
+  }
+  datum_y = y;
+  borrowed = true;
+}
+
+//------------------------------------------------------------------------------
+
+void Series::OwnData( void )
+{
+  if ( borrowed ) {
+    owned_x.assign( datum_x.begin(), datum_x.end() );
+    owned_y.assign( datum_y.begin(), datum_y.end() );
+    borrowed = false;
+    SyncData();
+  }
+}
+
+void Series::ExplicitX( void )
+{
+  if ( x_implicit ) {
+    OwnData();
+    owned_x.resize( owned_y.size() );
+    for ( size_t i = 0; i < owned_x.size(); i++ ) {
+      owned_x[ i ] = X( i );
+    }
+    x_implicit = false;
+    SyncData();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Datum Series::GetDatum( size_t idx )
+{
+  Datum datum( X( idx ), datum_y[ idx ] );
+  if ( !tag_list.empty() ) {
+    auto it =
+      std::lower_bound(
+        tag_list.cbegin(), tag_list.cend(), idx,
+        []( const tag_t& t, size_t idx ) { return t.idx < idx; }
+      );
+    if ( it != tag_list.cend() && it->idx == idx ) {
+      datum.tag_x = it->tag_x;
+      datum.tag_y = it->tag_y;
+    }
+  }
+  return datum;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -578,6 +768,69 @@ SVG::Point Series::MoveInside( SVG::Point p )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Series::SelectTags( std::vector< bool >& tag_select )
+{
+  tag_select.clear();
+  if ( !tag_enable || tag_budget == 0 || datum_y.size() <= tag_budget ) {
+    return;
+  }
+
+  bool bar_type =
+    type == SeriesType::Lollipop ||
+    type == SeriesType::Bar ||
+    type == SeriesType::StackedBar ||
+    type == SeriesType::LayeredBar;
+
+  std::vector< size_t > idx_list;
+  double sum = 0;
+  for ( size_t idx = 0; idx < datum_y.size(); ++idx ) {
+    if ( !axis_x->Valid( X( idx ) ) || !axis_y->Valid( datum_y[ idx ] ) ) {
+      continue;
+    }
+    idx_list.push_back( idx );
+    sum += datum_y[ idx ];
+  }
+  if ( idx_list.size() <= tag_budget ) return;
+  double ref = bar_type ? base : (sum / idx_list.size());
+
+  // Lower rank is better; within the same rank the values furthest from the
+  // reference value go first.
+  struct cand_t {
+    int    rank;
+    double dist;
+    size_t idx;
+  };
+  std::vector< cand_t > cand_list;
+  cand_list.reserve( idx_list.size() );
+  for ( size_t k = 0; k < idx_list.size(); ++k ) {
+    double y = datum_y[ idx_list[ k ] ];
+    int rank = 0;
+    if ( !bar_type && k > 0 && k + 1 < idx_list.size() ) {
+      double yp = datum_y[ idx_list[ k - 1 ] ];
+      double yn = datum_y[ idx_list[ k + 1 ] ];
+      bool extremum = (y > yp && y >= yn) || (y < yp && y <= yn);
+      rank = extremum ? 1 : 2;
+    }
+    cand_list.push_back( { rank, std::abs( y - ref ), idx_list[ k ] } );
+  }
+  std::nth_element(
+    cand_list.begin(), cand_list.begin() + tag_budget, cand_list.end(),
+    []( const cand_t& a, const cand_t& b )
+    {
+      if ( a.rank != b.rank ) return a.rank < b.rank;
+      if ( a.dist != b.dist ) return a.dist > b.dist;
+      return a.idx < b.idx;
+    }
+  );
+
+  tag_select.assign( datum_y.size(), false );
+  for ( size_t k = 0; k < tag_budget; ++k ) {
+    tag_select[ cand_list[ k ].idx ] = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void Series::UpdateLegendBoxes(
   Point p1, Point p2,
   bool p1_inc, bool p2_inc
@@ -585,30 +838,48 @@ void Series::UpdateLegendBoxes(
 {
   Point c1;
   Point c2;
-  for ( LegendBox& lb : *lb_list ) {
+  const std::vector< uint32_t >* idx_list = lb_index->Lookup( p1, p2 );
+  size_t n = idx_list ? idx_list->size() : lb_list->size();
+  for ( size_t i = 0; i < n; ++i ) {
+    uint32_t idx = idx_list ? (*idx_list)[ i ] : i;
+    LegendBox& lb = (*lb_list)[ idx ];
     if ( p1.x < lb.bb.min.x && p2.x < lb.bb.min.x ) continue;
     if ( p1.x > lb.bb.max.x && p2.x > lb.bb.max.x ) continue;
     if ( p1.y < lb.bb.min.y && p2.y < lb.bb.min.y ) continue;
     if ( p1.y > lb.bb.max.y && p2.y > lb.bb.max.y ) continue;
     bool p1_inside = Inside( p1, lb.bb );
     bool p2_inside = Inside( p2, lb.bb );
-    if ( p1_inside && p1_inc ) lb.weight1 += 1;
-    if ( p2_inside && p2_inc ) lb.weight1 += 1;
+    double weight1 = 0;
+    if ( p1_inside && p1_inc ) weight1 += 1;
+    if ( p2_inside && p2_inc ) weight1 += 1;
+    bool clipped = true;
     if ( p1_inside && p2_inside ) {
       c1 = p1;
       c2 = p2;
     } else {
       int c = ClipLine( c1, c2, p1, p2, lb.bb );
       if ( p1_inside || p2_inside ) {
-        if ( c != 1 ) continue;
+        clipped = (c == 1);
         c2 = p1_inside ? p1 : p2;
       } else {
-        if ( c != 2 ) continue;
+        clipped = (c == 2);
       }
     }
-    double dx = c1.x - c2.x;
-    double dy = c1.y - c2.y;
-    lb.weight2 += std::sqrt( dx*dx + dy*dy );
+    double weight2 = 0;
+    if ( clipped ) {
+      double dx = c1.x - c2.x;
+      double dy = c1.y - c2.y;
+      weight2 = std::sqrt( dx*dx + dy*dy );
+    } else
+    if ( weight1 == 0 ) {
+      continue;
+    }
+    if ( lb_record ) {
+      lb_inc_list.push_back( { idx, weight1, weight2 } );
+    } else {
+      lb.weight1 += weight1;
+      lb.weight2 += weight2;
+    }
   }
 }
 
@@ -839,78 +1110,97 @@ bool Series::SameLegend( Series* s1, Series* s2 )
 
 void Series::BuildMarker( Group* g, const MarkerDims& m, SVG::Point p )
 {
-  Poly* poly;
+  BuildMarkers( g, m, { p } );
+  return;
+}
 
+std::vector< Point > Series::MarkerSymbol( const MarkerDims& m )
+{
   switch ( marker_shape ) {
-    case MarkerShape::Circle :
-      g->Add( new Circle( p, m.x2 ) );
-      break;
     case MarkerShape::Square :
-      g->Add( new Rect(
-        p.x + m.x1, p.y + m.y1,
-        p.x + m.x2, p.y + m.y2
-      ) );
-      break;
+    case MarkerShape::LineX :
+    case MarkerShape::LineY :
+      return { { m.x1, m.y1 }, { m.x2, m.y2 } };
     case MarkerShape::Triangle :
-      poly =
-        new Poly(
-          { p.x, p.y + m.y2,
-            p.x + m.x2, p.y + m.y1,
-            p.x + m.x1, p.y + m.y1
-          }
-        );
-      poly->Close();
-      g->Add( poly );
-      break;
+      return { { 0, m.y2 }, { m.x2, m.y1 }, { m.x1, m.y1 } };
     case MarkerShape::InvTriangle :
-      poly =
-        new Poly(
-          { p.x, p.y + m.y1,
-            p.x + m.x2, p.y + m.y2,
-            p.x + m.x1, p.y + m.y2
-          }
-        );
-      poly->Close();
-      g->Add( poly );
-      break;
+      return { { 0, m.y1 }, { m.x2, m.y2 }, { m.x1, m.y2 } };
     case MarkerShape::Diamond :
-      poly =
-        new Poly(
-          { p.x + m.x2, p.y,
-            p.x, p.y + m.y2,
-            p.x + m.x1, p.y,
-            p.x, p.y + m.y1
-          }
-        );
-      poly->Close();
-      g->Add( poly );
-      break;
+      return { { m.x2, 0 }, { 0, m.y2 }, { m.x1, 0 }, { 0, m.y1 } };
     case MarkerShape::Cross :
-      g = g->AddNewGroup();
-      g->Add(
-        new Line(
-          p.x + m.x1, p.y + m.y1,
-          p.x + m.x2, p.y + m.y2
-        )
-      );
-      g->Add(
-        new Line(
-          p.x + m.x2, p.y + m.y1,
-          p.x + m.x1, p.y + m.y2
-        )
-      );
-      break;
-    case MarkerShape::LineX :
-    case MarkerShape::LineY :
-      g->Add(
-        new Line(
-          p.x + m.x1, p.y + m.y1,
-          p.x + m.x2, p.y + m.y2
-        )
-      );
-      break;
+      return { { m.x1, m.y1 }, { m.x2, m.y2 }, { m.x2, m.y1 }, { m.x1, m.y2 } };
     default :
-      break;
+      return {};
+  }
+}
+
+void Series::BuildMarkers(
+  Group* g, const MarkerDims& m, const std::vector< SVG::Point >& points
+)
+{
+  std::vector< Point > sym = MarkerSymbol( m );
+
+  auto at = [&]( Point p, size_t i )
+  {
+    return Point( p.x + sym[ i ].x, p.y + sym[ i ].y );
+  };
+
+  if (
+    marker_compound && points.size() > 1 &&
+    ( marker_shape == MarkerShape::Square ||
+      marker_shape == MarkerShape::Triangle ||
+      marker_shape == MarkerShape::InvTriangle ||
+      marker_shape == MarkerShape::Diamond
+    )
+  ) {
+    if ( marker_shape == MarkerShape::Square ) {
+      sym = {
+        sym[ 0 ], { sym[ 1 ].x, sym[ 0 ].y },
+        sym[ 1 ], { sym[ 0 ].x, sym[ 1 ].y }
+      };
+    }
+    compound_t compound;
+    for ( const Point& p : points ) {
+      AddCompound( compound, p, sym );
+    }
+    EndCompound( compound, g );
+    return;
+  }
+
+  for ( const Point& p : points ) {
+    switch ( marker_shape ) {
+      case MarkerShape::Circle :
+        g->Add( new Circle( p, m.x2 ) );
+        break;
+      case MarkerShape::Square :
+        g->Add( new Rect( at( p, 0 ), at( p, 1 ) ) );
+        break;
+      case MarkerShape::Triangle :
+      case MarkerShape::InvTriangle :
+      case MarkerShape::Diamond :
+        {
+          Poly* poly = new Poly();
+          for ( size_t i = 0; i < sym.size(); ++i ) {
+            poly->Add( at( p, i ) );
+          }
+          poly->Close();
+          g->Add( poly );
+        }
+        break;
+      case MarkerShape::Cross :
+        {
+          Group* cross_g = g->AddNewGroup();
+          cross_g->Add( new Line( at( p, 0 ), at( p, 1 ) ) );
+          cross_g->Add( new Line( at( p, 2 ), at( p, 3 ) ) );
+        }
+        break;
+      case MarkerShape::LineX :
+      case MarkerShape::LineY :
+        g->Add( new Line( at( p, 0 ), at( p, 1 ) ) );
+        break;
+      default :
+        break;
+    }
   }
 
   return;
@@ -924,8 +1214,8 @@ int Series::GetStackDir( void )
     return 0;
   }
   double sum = 0;
-  for ( const Datum& datum : datum_list ) {
-    if ( axis_y->Valid( datum.y ) ) sum += datum.y - base;
+  for ( double y : datum_y ) {
+    if ( axis_y->Valid( y ) ) sum += y - base;
   }
   return (sum < 0) ? -1 : 1;
 }
@@ -976,9 +1266,10 @@ void Series::DetermineMinMax(
     }
   }
 
-  for ( auto& datum : datum_list ) {
-    double x = datum.x;
-    double y = datum.y;
+  auto tag_it = tag_list.cbegin();
+  for ( size_t idx = 0; idx < datum_y.size(); ++idx ) {
+    double x = X( idx );
+    double y = datum_y[ idx ];
     if ( !axis_x->Valid( x ) ) continue;
     if ( !axis_y->Valid( y ) ) continue;
     if ( stackable ) {
@@ -993,10 +1284,20 @@ void Series::DetermineMinMax(
       }
       if ( !axis_y->Valid( y ) ) continue;
     }
-    max_tag_x_size = std::max( max_tag_x_size, datum.tag_x.size() );
-    max_tag_y_size = std::max( max_tag_y_size, datum.tag_y.size() );
-    if ( !def_x || min_x > x ) min_x = x;
-    if ( !def_x || max_x < x ) max_x = x;
+    while ( tag_it != tag_list.cend() && tag_it->idx < idx ) ++tag_it;
+    if ( tag_it != tag_list.cend() && tag_it->idx == idx ) {
+      max_tag_x_size = std::max( max_tag_x_size, tag_it->tag_x.size() );
+      max_tag_y_size = std::max( max_tag_y_size, tag_it->tag_y.size() );
+    }
+    if ( x_implicit ) {
+      // X-values are monotonic, so only the first and last valid X-values
+      // count; they are put in order below, as the step may be negative.
+      if ( !def_x ) min_x = x;
+      max_x = x;
+    } else {
+      if ( !def_x || min_x > x ) min_x = x;
+      if ( !def_x || max_x < x ) max_x = x;
+    }
     if ( !def_y || min_y > y ) {
       min_y = y;
       min_y_is_base = false;
@@ -1008,6 +1309,8 @@ void Series::DetermineMinMax(
     def_x = true;
     def_y = true;
   }
+  // Implicit X-values with a negative step are decreasing.
+  if ( def_x && min_x > max_x ) std::swap( min_x, max_x );
 
   return;
 }
@@ -1040,39 +1343,52 @@ void Series::BuildArea(
     tag_direction = reverse ? Pos::Left : Pos::Right;
   }
 
-  // Normalize number of elements in datum_list by inserting invalid values
-  // before and after the defined values as needed.
+  // Normalize number of data points by inserting invalid values before and
+  // after the defined values as needed.
+  // Implicit X-values are kept only if they are the category indices.
+  OwnData();
+  if (
+    x_implicit &&
+    (x_step != 1 || x_start < 0 || x_start != std::floor( x_start ))
+  ) {
+    ExplicitX();
+  }
   {
-    if ( !datum_list.empty() ) {
-      size_t n = datum_list[ 0 ].x;
+    if ( !owned_y.empty() ) {
+      size_t n = X( 0 );
       if ( n > 0 ) {
-        datum_list.resize( datum_list.size() + n );
-        std::move_backward(
-          datum_list.begin(),
-          datum_list.begin() + datum_list.size() - n,
-          datum_list.end()
-        );
-        for ( size_t i = 0; i < n; i++ ) {
-          datum_list[ i ] = Datum( i, num_invalid );
+        if ( x_implicit ) {
+          x_start = 0;
+        } else {
+          owned_x.insert( owned_x.begin(), n, 0 );
+          for ( size_t i = 0; i < n; i++ ) {
+            owned_x[ i ] = i;
+          }
+        }
+        owned_y.insert( owned_y.begin(), n, num_invalid );
+        for ( auto& t : tag_list ) {
+          t.idx += n;
         }
       }
     }
     size_t n = ofs_pos->size();
-    for ( size_t i = datum_list.size(); i < n; i++ ) {
-      datum_list.emplace_back( i, num_invalid );
+    for ( size_t i = owned_y.size(); i < n; i++ ) {
+      if ( !x_implicit ) owned_x.push_back( i );
+      owned_y.push_back( num_invalid );
     }
   }
 
   // Replace leading/trailing skipped data points in the series with invalid
   // number.
-  for ( auto it = datum_list.begin(); it != datum_list.end(); ++it ) {
-    if ( axis_y->Valid( it->y ) ) break;
-    it->y = num_invalid;
+  for ( auto it = owned_y.begin(); it != owned_y.end(); ++it ) {
+    if ( axis_y->Valid( *it ) ) break;
+    *it = num_invalid;
   }
-  for ( auto it = datum_list.rbegin(); it != datum_list.rend(); ++it ) {
-    if ( axis_y->Valid( it->y ) ) break;
-    it->y = num_invalid;
+  for ( auto it = owned_y.rbegin(); it != owned_y.rend(); ++it ) {
+    if ( axis_y->Valid( *it ) ) break;
+    *it = num_invalid;
   }
+  SyncData();
 
   bool first_in_stack = (stack_dir < 0) ? pts_neg->empty() : pts_pos->empty();
 
@@ -1099,23 +1415,16 @@ void Series::BuildArea(
   {
     if ( !line_points.empty() ) {
       PrunePoly( line_points );
-      auto it = line_points.cbegin();
-      uint64_t max_poly = 1024;
-      uint64_t d = (line_points.size() + max_poly - 1) / max_poly;
-      uint64_t n = 0;
-      for ( uint64_t i = 1; i <= d; ++i ) {
-        uint64_t m = line_points.size() * i / d;
-        Poly* poly = new Poly();
-        line_g->Add( poly );
-        while ( n < m ) {
-          poly->Add( *(it++) );
-          ++n;
-        }
-      }
+      RoundPoints( line_points );
+      AddPolylines( line_g, line_points );
       line_points.clear();
     }
   };
 
+  std::vector< bool > tag_select;
+  SelectTags( tag_select );
+  bool tag_ok = true;
+
   Point ap_prv_p;
   size_t ap_line_cnt = 0;
   auto add_point =
@@ -1145,7 +1454,7 @@ void Series::BuildArea(
     }
     if ( tag_enable ) {
       tag_db->LineTag(
-        this, tag_g, p, datum, is_datum,
+        this, tag_g, p, datum, is_datum && tag_ok,
         has_line && on_line && ap_line_cnt > 0, tag_direction
       );
     }
@@ -1206,7 +1515,7 @@ void Series::BuildArea(
     return;
   };
 
-  if ( !datum_list.empty() ) {
+  if ( !datum_y.empty() ) {
     Datum dummy_datum;
     Point beg_p{
       axis_x->Coor( 0 ),
@@ -1220,9 +1529,11 @@ void Series::BuildArea(
     double prv_base = 0;
     bool prv_valid = false;
     bool first = true;
-    for ( const Datum& datum : datum_list ) {
+    for ( size_t idx = 0; idx < datum_y.size(); ++idx ) {
+      Datum datum = GetDatum( idx );
       size_t i = datum.x;
       double y = datum.y;
+      tag_ok = tag_select.empty() || tag_select[ idx ];
       if ( axis_y->Skip( datum.y ) ) {
         continue;
       }
@@ -1256,6 +1567,8 @@ void Series::BuildArea(
 
   if ( !fill_points.empty() ) {
     PrunePoly( fill_points );
+    RoundPoints( fill_points );
+    points_out += fill_points.size();
     Poly* poly = new Poly();
     fill_g->Add( poly );
     for ( auto& p : fill_points ) {
@@ -1268,10 +1581,9 @@ void Series::BuildArea(
 
   if ( !mark_points.empty() ) {
     PrunePoints( mark_points );
-    for ( auto& p : mark_points ) {
-      if ( marker_show_out ) BuildMarker( mark_g, marker_out, p );
-      if ( marker_show_int ) BuildMarker( hole_g, marker_int, p );
-    }
+    points_out += mark_points.size();
+    if ( marker_show_out ) BuildMarkers( mark_g, marker_out, mark_points );
+    if ( marker_show_int ) BuildMarkers( hole_g, marker_int, mark_points );
   }
 
   return;
@@ -1296,9 +1608,9 @@ void Series::BuildBar(
   {
     bool has_pos_bar = false;
     bool has_neg_bar = false;
-    for ( const Datum& datum : datum_list ) {
-      if ( datum.y - base > 0 ) has_pos_bar = true;
-      if ( datum.y - base < 0 ) has_neg_bar = true;
+    for ( double y : datum_y ) {
+      if ( y - base > 0 ) has_pos_bar = true;
+      if ( y - base < 0 ) has_neg_bar = true;
     }
     if ( axis_x->angle == 0 ) {
       if ( axis_y->reverse ) {
@@ -1334,14 +1646,36 @@ void Series::BuildBar(
     }
   }
 
+  std::vector< Point > mark_points;
+
+  compound_t fill_compound;
+  compound_t tbar_compound;
+
+  // Add a rectangle either as an object of its own or to the compound.
+  auto add_rect = [&]( Group* g, compound_t& compound, Point c1, Point c2 )
+  {
+    if ( bar_compound ) {
+      AddCompound(
+        compound, Point( 0, 0 ),
+        { c1, Point( c2.x, c1.y ), c2, Point( c1.x, c2.y ) }
+      );
+    } else {
+      g->Add( new Rect( c1, c2 ) );
+    }
+  };
+
+  std::vector< bool > tag_select;
+  SelectTags( tag_select );
+
   Point p1;
   Point p2;
 
-  for ( const Datum& datum : datum_list ) {
+  for ( size_t idx = 0; idx < datum_y.size(); ++idx ) {
+    bool valid = axis_y->Valid( datum_y[ idx ] );
+    if ( !valid ) continue;
+    Datum datum = GetDatum( idx );
     size_t i = datum.x;
     double x = datum.x + cx;
-    bool valid = axis_y->Valid( datum.y );
-    if ( !valid ) continue;
 
     U q = axis_x->Coor( x );
     p1.x = p2.x = q;
@@ -1392,10 +1726,10 @@ void Series::BuildBar(
 
     if ( html_db && p2_inside ) {
       html_db->AddSnapPoint( this, p2, datum.x, datum.tag_y );
-      html_db->DontPruneSnapPoint( p2 );
+      html_db->DontPruneSnapPoint( this, p2 );
     }
 
-    if ( tag_enable ) {
+    if ( tag_enable && (tag_select.empty() || tag_select[ idx ]) ) {
       Pos direction = zero_direction;
       if ( p2.x > p1.x ) direction = Pos::Right;
       if ( p2.x < p1.x ) direction = Pos::Left;
@@ -1407,8 +1741,7 @@ void Series::BuildBar(
     if ( type == SeriesType::Lollipop ) {
       line_g->Add( new Line( p1, p2 ) );
       if ( p2_inside && marker_show ) {
-        if ( marker_show_out ) BuildMarker( mark_g, marker_out, p2 );
-        if ( marker_show_int ) BuildMarker( hole_g, marker_int, p2 );
+        mark_points.push_back( p2 );
       }
       UpdateLegendBoxes( p1, p2, false, true );
     }
@@ -1458,6 +1791,7 @@ void Series::BuildBar(
       UpdateLegendBoxes( Point( p1.x, p1.y ), Point( p2.x, p1.y ) );
       UpdateLegendBoxes( Point( p2.x, p1.y ), Point( p2.x, p2.y ) );
       UpdateLegendBoxes( Point( p1.x, p2.y ), Point( p2.x, p2.y ) );
+      points_out++;
       bool has_interior =
         p2.x - p1.x > line_width &&
         p2.y - p1.y > line_width;
@@ -1473,7 +1807,7 @@ void Series::BuildBar(
             c1.y += cut_bot ? -d : +q;
             c2.y -= cut_top ? -d : +q;
           }
-          fill_g->Add( new Rect( c1, c2 ) );
+          add_rect( fill_g, fill_compound, c1, c2 );
         }
         if ( has_line ) {
           U d = line_width / 2;
@@ -1518,17 +1852,270 @@ void Series::BuildBar(
           }
         }
       } else {
-        tbar_g->Add( new Rect( p1, p2 ) );
+        add_rect( tbar_g, tbar_compound, p1, p2 );
       }
     }
 
   }
 
+  EndCompound( fill_compound, fill_g );
+  EndCompound( tbar_compound, tbar_g );
+
+  points_out += mark_points.size();
+  if ( marker_show_out ) BuildMarkers( mark_g, marker_out, mark_points );
+  if ( marker_show_int ) BuildMarkers( hole_g, marker_int, mark_points );
+
   return;
 }
 
 //------------------------------------------------------------------------------
 
+void Series::AddCompound(
+  compound_t& compound, Point p, const std::vector< Point >& shape
+)
+{
+  if ( compound.poly == nullptr ) compound.poly = new Poly();
+  for ( const Point& s : shape ) {
+    compound.poly->Add( Point( p.x + s.x, p.y + s.y ) );
+  }
+  Point first( p.x + shape[ 0 ].x, p.y + shape[ 0 ].y );
+  compound.poly->Add( first );
+  compound.bridge.push_back( first );
+}
+
+void Series::EndCompound( compound_t& compound, Group* g )
+{
+  if ( compound.poly == nullptr ) return;
+  compound.bridge.pop_back();
+  while ( !compound.bridge.empty() ) {
+    compound.poly->Add( compound.bridge.back() );
+    compound.bridge.pop_back();
+  }
+  compound.poly->Close();
+  g->Add( compound.poly );
+  compound.poly = nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+void Series::DecimateColumns( std::vector< size_t >& keep, bool selected )
+{
+  std::vector< size_t > sel;
+  if ( selected ) sel.swap( keep );
+  keep.clear();
+
+  bool in_run = false;
+  int64_t run_col = 0;
+  size_t run_beg = 0;
+  size_t run_end = 0;
+  size_t run_min = 0;
+  size_t run_max = 0;
+
+  auto end_run = [&]( void )
+  {
+    if ( !in_run ) return;
+    size_t a[] = { run_beg, run_min, run_max, run_end };
+    std::sort( std::begin( a ), std::end( a ) );
+    for ( size_t idx : a ) {
+      if ( keep.empty() || keep.back() != idx ) keep.push_back( idx );
+    }
+    in_run = false;
+  };
+
+  // The X-coordinates are converted in chunks.
+  double vx[ coor_chunk ];
+  double cx[ coor_chunk ];
+
+  size_t cnt = selected ? sel.size() : datum_y.size();
+  for ( size_t k = 0; k < cnt; ++k ) {
+    size_t j = k % coor_chunk;
+    if ( j == 0 ) {
+      size_t m = std::min( coor_chunk, cnt - k );
+      for ( size_t i = 0; i < m; ++i ) {
+        vx[ i ] = X( selected ? sel[ k + i ] : k + i );
+      }
+      axis_x->CoorBatch( vx, cx, m );
+    }
+    size_t idx = selected ? sel[ k ] : k;
+    double x = vx[ j ];
+    double y = datum_y[ idx ];
+    if ( !axis_x->Valid( x ) || !axis_y->Valid( y ) ) {
+      // Keep invalid and skipped data points as they affect the line.
+      end_run();
+      keep.push_back( idx );
+      continue;
+    }
+    // The axis transformation is monotonic, so the min/max data point within
+    // a column can be determined from the Y-value itself.
+    int64_t col = std::floor( std::clamp( cx[ j ], -1e18, +1e18 ) );
+    if ( in_run && col == run_col ) {
+      if ( y < datum_y[ run_min ] ) run_min = idx;
+      if ( y > datum_y[ run_max ] ) run_max = idx;
+      run_end = idx;
+    } else {
+      end_run();
+      in_run = true;
+      run_col = col;
+      run_beg = run_end = run_min = run_max = idx;
+    }
+  }
+  end_run();
+}
+
+//------------------------------------------------------------------------------
+
+void Series::DownsampleLTTB( std::vector< size_t >& keep )
+{
+  keep.clear();
+
+  // Split the data points into runs of valid data points. Invalid data points
+  // break the line; the first invalid data point between two runs is kept as
+  // the break, while the other invalid data points and the skipped data
+  // points do not affect the line and are dropped. brk_list[ r ] is the break
+  // following run_list[ r ].
+  std::vector< std::vector< size_t > > run_list;
+  std::vector< size_t > brk_list;
+  size_t brk = 0;
+  bool in_gap = true;
+  for ( size_t idx = 0; idx < datum_y.size(); ++idx ) {
+    double x = X( idx );
+    double y = datum_y[ idx ];
+    if ( axis_x->Valid( x ) && axis_y->Valid( y ) ) {
+      if ( in_gap ) {
+        if ( !run_list.empty() ) brk_list.push_back( brk );
+        run_list.emplace_back();
+        in_gap = false;
+      }
+      run_list.back().push_back( idx );
+    } else
+    if ( !axis_x->Skip( x ) && !(axis_x->Valid( x ) && axis_y->Skip( y )) ) {
+      if ( !in_gap ) brk = idx;
+      in_gap = true;
+    }
+  }
+
+  // Each run keeps at least its first and last data point, and each break is
+  // kept. If that alone exceeds the budget, neighbouring runs are joined into
+  // groups, and only the breaks between the groups are kept.
+  size_t need = brk_list.size();
+  for ( const auto& run : run_list ) {
+    need += std::min( run.size(), size_t( 2 ) );
+  }
+  if ( need > max_points ) {
+    size_t grp_cnt = std::max( size_t( 1 ), max_points / 4 );
+    std::vector< std::vector< size_t > > grp_list( grp_cnt );
+    std::vector< size_t > grp_brk_list;
+    for ( size_t g = 0; g < grp_cnt; ++g ) {
+      size_t beg = run_list.size() * g / grp_cnt;
+      size_t end = run_list.size() * (g + 1) / grp_cnt;
+      if ( g > 0 ) grp_brk_list.push_back( brk_list[ beg - 1 ] );
+      for ( size_t r = beg; r < end; ++r ) {
+        grp_list[ g ].insert(
+          grp_list[ g ].end(), run_list[ r ].cbegin(), run_list[ r ].cend()
+        );
+      }
+    }
+    run_list.swap( grp_list );
+    brk_list.swap( grp_brk_list );
+  }
+
+  // Distribute the rest of the budget over the runs in proportion to their
+  // remaining data points; the leftover from rounding down goes to the runs
+  // with the largest fractions.
+  std::vector< size_t > m_list;
+  size_t base_cnt = brk_list.size();
+  size_t rest_cnt = 0;
+  for ( const auto& run : run_list ) {
+    m_list.push_back( std::min( run.size(), size_t( 2 ) ) );
+    base_cnt += m_list.back();
+    rest_cnt += run.size() - m_list.back();
+  }
+  if ( max_points > base_cnt && rest_cnt > 0 ) {
+    size_t extra = std::min( max_points - base_cnt, rest_cnt );
+    size_t given = 0;
+    std::vector< double > frac_list;
+    std::vector< size_t > order;
+    for ( size_t r = 0; r < run_list.size(); ++r ) {
+      double share =
+        double( extra ) * (run_list[ r ].size() - m_list[ r ]) / rest_cnt;
+      size_t n = size_t( share );
+      m_list[ r ] += n;
+      given += n;
+      frac_list.push_back( share - n );
+      order.push_back( r );
+    }
+    std::stable_sort(
+      order.begin(), order.end(),
+      [&]( size_t a, size_t b ) { return frac_list[ a ] > frac_list[ b ]; }
+    );
+    for ( size_t i = 0; i < order.size() && given < extra; ++i ) {
+      size_t r = order[ i ];
+      if ( m_list[ r ] < run_list[ r ].size() ) {
+        ++m_list[ r ];
+        ++given;
+      }
+    }
+  }
+
+  auto area = [&]( size_t a, double bx, double by, size_t c )
+  {
+    double ax = X( a );
+    double ay = datum_y[ a ];
+    return
+      std::abs( (ax - bx) * (datum_y[ c ] - ay) - (ax - X( c )) * (by - ay) );
+  };
+
+  for ( size_t r = 0; r < run_list.size(); ++r ) {
+    const auto& run = run_list[ r ];
+    size_t len = run.size();
+    size_t m = m_list[ r ];
+    if ( m >= len ) {
+      keep.insert( keep.end(), run.cbegin(), run.cend() );
+    } else
+    if ( m == 2 ) {
+      keep.push_back( run.front() );
+      keep.push_back( run.back() );
+    } else {
+      // The first and last data points are always kept; the remaining data
+      // points are divided into m-2 buckets, and from each bucket the data
+      // point forming the largest triangle with the previously kept data point
+      // and the average of the next bucket is kept.
+      double every = double( len - 2 ) / (m - 2);
+      size_t a = run.front();
+      keep.push_back( a );
+      for ( size_t b = 0; b < m - 2; ++b ) {
+        size_t beg = size_t( b * every ) + 1;
+        size_t end = size_t( (b + 1) * every ) + 1;
+        size_t nxt_beg = end;
+        size_t nxt_end = std::min( size_t( (b + 2) * every ) + 1, len );
+        double avg_x = 0;
+        double avg_y = 0;
+        for ( size_t i = nxt_beg; i < nxt_end; ++i ) {
+          avg_x += X( run[ i ] );
+          avg_y += datum_y[ run[ i ] ];
+        }
+        avg_x /= nxt_end - nxt_beg;
+        avg_y /= nxt_end - nxt_beg;
+        size_t sel = run[ beg ];
+        double sel_area = -1;
+        for ( size_t i = beg; i < end; ++i ) {
+          double d = area( a, avg_x, avg_y, run[ i ] );
+          if ( d > sel_area ) {
+            sel_area = d;
+            sel = run[ i ];
+          }
+        }
+        keep.push_back( sel );
+        a = sel;
+      }
+      keep.push_back( run.back() );
+    }
+    if ( r < brk_list.size() ) keep.push_back( brk_list[ r ] );
+  }
+}
+
+//------------------------------------------------------------------------------
+
 void Series::BuildLine(
   Group* line_g,
   Group* mark_g,
@@ -1548,6 +2135,10 @@ void Series::BuildLine(
     tag_direction = axis_y->reverse ? Pos::Left : Pos::Right;
   }
 
+  std::vector< bool > tag_select;
+  SelectTags( tag_select );
+  bool tag_ok = true;
+
   Point prv;
   auto add_point =
     [&]( Point p, const Datum& datum, bool clipped = false )
@@ -1572,7 +2163,7 @@ void Series::BuildLine(
     }
     if ( tag_enable ) {
       tag_db->LineTag(
-        this, tag_g, p, datum, !clipped,
+        this, tag_g, p, datum, !clipped && tag_ok,
         adding_segments && has_line, tag_direction
       );
     }
@@ -1583,44 +2174,65 @@ void Series::BuildLine(
   {
     if ( !line_points.empty() ) {
       PrunePoly( line_points );
-      auto it = line_points.cbegin();
-      uint64_t max_poly = 1024;
-      uint64_t d = (line_points.size() + max_poly - 1) / max_poly;
-      uint64_t n = 0;
-      for ( uint64_t i = 1; i <= d; ++i ) {
-        uint64_t m = line_points.size() * i / d;
-        Poly* poly = new Poly();
-        line_g->Add( poly );
-        while ( n < m ) {
-          poly->Add( *(it++) );
-          ++n;
-        }
-      }
+      RoundPoints( line_points );
+      AddPolylines( line_g, line_points );
       line_points.clear();
     }
     if ( !mark_points.empty() ) {
       PrunePoints( mark_points );
-      for ( auto& p : mark_points ) {
-        if ( marker_show_out ) BuildMarker( mark_g, marker_out, p );
-        if ( marker_show_int ) BuildMarker( hole_g, marker_int, p );
-      }
+      points_out += mark_points.size();
+      if ( marker_show_out ) BuildMarkers( mark_g, marker_out, mark_points );
+      if ( marker_show_int ) BuildMarkers( hole_g, marker_int, mark_points );
       mark_points.clear();
     }
     adding_segments = false;
-    tag_db->EndLineTag();
+    if ( tag_enable ) tag_db->EndLineTag();
   };
 
+  // Select the data points to build if the series is downsampled or
+  // decimated.
+  std::vector< size_t > keep;
+  bool selected = false;
+  if ( max_points > 0 && datum_y.size() > max_points ) {
+    DownsampleLTTB( keep );
+    selected = true;
+  }
+  if ( column_decimation && !marker_show && !tag_enable ) {
+    DecimateColumns( keep, selected );
+    selected = true;
+  }
+  size_t cnt = selected ? keep.size() : datum_y.size();
+
+  // The coordinates are converted in chunks.
+  double vx[ coor_chunk ];
+  double vy[ coor_chunk ];
+  double cx[ coor_chunk ];
+  double cy[ coor_chunk ];
+
   bool first = true;
   Point cur;
   Point old;
-  for ( const Datum& datum : datum_list ) {
+  for ( size_t k = 0; k < cnt; ++k ) {
+    size_t j = k % coor_chunk;
+    if ( j == 0 ) {
+      size_t m = std::min( coor_chunk, cnt - k );
+      for ( size_t i = 0; i < m; ++i ) {
+        size_t idx = selected ? keep[ k + i ] : k + i;
+        vx[ i ] = X( idx );
+        vy[ i ] = datum_y[ idx ];
+      }
+      axis_x->CoorBatch( vx, cx, m );
+      axis_y->CoorBatch( vy, cy, m );
+    }
+    Datum datum = GetDatum( selected ? keep[ k ] : k );
+    tag_ok = tag_select.empty() || tag_select[ selected ? keep[ k ] : k ];
     old = cur;
     if ( axis_x->angle == 0 ) {
-      cur.x = axis_x->Coor( datum.x );
-      cur.y = axis_y->Coor( datum.y );
+      cur.x = cx[ j ];
+      cur.y = cy[ j ];
     } else {
-      cur.y = axis_x->Coor( datum.x );
-      cur.x = axis_y->Coor( datum.y );
+      cur.y = cx[ j ];
+      cur.x = cy[ j ];
     }
     bool valid = axis_x->Valid( datum.x ) && axis_y->Valid( datum.y );
     bool inside = Inside( cur );
@@ -1676,6 +2288,83 @@ void Series::BuildLine(
 
 //------------------------------------------------------------------------------
 
+void Series::BuildDensity(
+  Group* mark_g
+)
+{
+  double cell = std::max( +density_cell, 1.0 );
+  double w = chart_area.max.x - chart_area.min.x;
+  double h = chart_area.max.y - chart_area.min.y;
+  size_t nx = std::max( 1.0, std::ceil( w / cell ) );
+  size_t ny = std::max( 1.0, std::ceil( h / cell ) );
+
+  std::vector< uint32_t > cnt_list( nx * ny, 0 );
+  uint32_t max_cnt = 0;
+
+  // The coordinates are converted in chunks.
+  double vx[ coor_chunk ];
+  double vy[ coor_chunk ];
+  double cx[ coor_chunk ];
+  double cy[ coor_chunk ];
+
+  for ( size_t k = 0; k < datum_y.size(); k += coor_chunk ) {
+    size_t m = std::min( coor_chunk, datum_y.size() - k );
+    for ( size_t i = 0; i < m; ++i ) {
+      vx[ i ] = X( k + i );
+      vy[ i ] = datum_y[ k + i ];
+    }
+    axis_x->CoorBatch( vx, cx, m );
+    axis_y->CoorBatch( vy, cy, m );
+    for ( size_t i = 0; i < m; ++i ) {
+      if ( !axis_x->Valid( vx[ i ] ) || !axis_y->Valid( vy[ i ] ) ) continue;
+      Point p{ cx[ i ], cy[ i ] };
+      if ( axis_x->angle != 0 ) std::swap( p.x, p.y );
+      if ( !Inside( p ) ) continue;
+      size_t bx = std::min( nx - 1, size_t( (p.x - chart_area.min.x) / cell ) );
+      size_t by = std::min( ny - 1, size_t( (p.y - chart_area.min.y) / cell ) );
+      max_cnt = std::max( max_cnt, ++cnt_list[ by * nx + bx ] );
+    }
+  }
+  if ( max_cnt == 0 ) return;
+
+  // The cells are shaded in a number of opacity levels on a logarithmic scale,
+  // with one group per level.
+  const int levels = 8;
+  Group* level_g[ levels ] = {};
+
+  density_tags.clear();
+
+  for ( size_t by = 0; by < ny; ++by ) {
+    for ( size_t bx = 0; bx < nx; ++bx ) {
+      uint32_t cnt = cnt_list[ by * nx + bx ];
+      if ( cnt == 0 ) continue;
+      int l = std::ceil( levels * std::log1p( cnt ) / std::log1p( max_cnt ) );
+      l = std::clamp( l, 1, levels ) - 1;
+      if ( level_g[ l ] == nullptr ) {
+        level_g[ l ] = mark_g->AddNewGroup();
+        level_g[ l ]->Attr()->LineColor()->Clear();
+        level_g[ l ]->Attr()->FillColor()->Set( &line_color );
+        level_g[ l ]->Attr()->FillColor()->SetOpacity( (l + 1.0) / levels );
+      }
+      Point p1{ chart_area.min.x + bx * cell, chart_area.min.y + by * cell };
+      Point p2{
+        std::min( p1.x + cell, +chart_area.max.x ),
+        std::min( p1.y + cell, +chart_area.max.y )
+      };
+      level_g[ l ]->Add( new Rect( p1, p2 ) );
+      points_out++;
+      Point c{ (p1.x + p2.x) / 2, (p1.y + p2.y) / 2 };
+      UpdateLegendBoxes( c, c, true, false );
+      if ( html_db ) {
+        density_tags.push_back( std::to_string( cnt ) );
+        html_db->AddSnapPoint( this, c, "count", density_tags.back() );
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
 void Series::Build(
   SVG::Group* main_g,
   SVG::Group* line_g,
@@ -1689,6 +2378,67 @@ void Series::Build(
   std::vector< SVG::Point >* pts_pos,
   std::vector< SVG::Point >* pts_neg
 )
+{
+  BuildGroups( main_g, line_g, area_fill_g, marker_g, tag_g );
+  BuildContent( bar_num, bar_tot, ofs_pos, ofs_neg, pts_pos, pts_neg );
+}
+
+void Series::BuildGroups(
+  SVG::Group* main_g,
+  SVG::Group* line_g,
+  SVG::Group* area_fill_g,
+  SVG::Group* marker_g,
+  SVG::Group* tag_g
+)
+{
+  build_g = {};
+
+  if ( type == SeriesType::Area || type == SeriesType::StackedArea ) {
+    build_g.fill_g = area_fill_g->AddNewGroup();
+  } else {
+    build_g.fill_g = main_g->AddNewGroup();
+  }
+  ApplyFillStyle( build_g.fill_g );
+
+  // Tiny bars.
+  if ( has_line ) {
+    build_g.tbar_g = line_g->AddNewGroup();
+    build_g.tbar_g->Attr()->LineColor()->Clear();
+    build_g.tbar_g->Attr()->FillColor()->Set( &line_color );
+  } else {
+    build_g.tbar_g = main_g->AddNewGroup();
+    ApplyFillStyle( build_g.tbar_g );
+  }
+
+  if ( bar_layer_tot > 1 ) {
+    build_g.line_g = main_g->AddNewGroup();
+  } else {
+    build_g.line_g = line_g->AddNewGroup();
+    if ( type == SeriesType::Bar || type == SeriesType::StackedBar ) {
+      line_g->FrontToBack();
+    }
+  }
+  ApplyLineStyle( build_g.line_g );
+
+  if ( marker_g != nullptr ) {
+    build_g.mark_g = marker_g->AddNewGroup();
+    ApplyMarkStyle( build_g.mark_g );
+    build_g.hole_g = marker_g->AddNewGroup();
+    ApplyHoleStyle( build_g.hole_g );
+  }
+
+  build_g.tag_g = tag_g->AddNewGroup();
+  ApplyTagStyle( build_g.tag_g );
+}
+
+void Series::BuildContent(
+  uint32_t bar_num,
+  uint32_t bar_tot,
+  std::vector< double >* ofs_pos,
+  std::vector< double >* ofs_neg,
+  std::vector< SVG::Point >* pts_pos,
+  std::vector< SVG::Point >* pts_neg
+)
 {
   // Used for extra margin in comparisons to account for precision issues. This
   // may cause an unintended extra clip-detection near the corners, but the
@@ -1710,47 +2460,16 @@ void Series::Build(
   chart_area.max.x += e1;
   chart_area.max.y += e1;
 
-  Group* fill_g = nullptr;
-  Group* tbar_g = nullptr;
-  Group* mark_g = nullptr;
-  Group* hole_g = nullptr;
-
-  if ( type == SeriesType::Area || type == SeriesType::StackedArea ) {
-    fill_g = area_fill_g->AddNewGroup();
-  } else {
-    fill_g = main_g->AddNewGroup();
-  }
-  ApplyFillStyle( fill_g );
-
-  // Tiny bars.
-  if ( has_line ) {
-    tbar_g = line_g->AddNewGroup();
-    tbar_g->Attr()->LineColor()->Clear();
-    tbar_g->Attr()->FillColor()->Set( &line_color );
-  } else {
-    tbar_g = main_g->AddNewGroup();
-    ApplyFillStyle( tbar_g );
-  }
-
-  if ( bar_layer_tot > 1 ) {
-    line_g = main_g->AddNewGroup();
-  } else {
-    line_g = line_g->AddNewGroup();
-    if ( type == SeriesType::Bar || type == SeriesType::StackedBar ) {
-      line_g->ParrentGroup()->FrontToBack();
-    }
-  }
-  ApplyLineStyle( line_g );
+  Stats* stats = &main->ensemble->stats;
+  double start_ms = stats->Now();
+  points_out = 0;
 
-  if ( marker_g != nullptr ) {
-    mark_g = marker_g->AddNewGroup();
-    ApplyMarkStyle( mark_g );
-    hole_g = marker_g->AddNewGroup();
-    ApplyHoleStyle( hole_g );
-  }
-
-  tag_g = tag_g->AddNewGroup();
-  ApplyTagStyle( tag_g );
+  Group* fill_g = build_g.fill_g;
+  Group* tbar_g = build_g.tbar_g;
+  Group* line_g = build_g.line_g;
+  Group* mark_g = build_g.mark_g;
+  Group* hole_g = build_g.hole_g;
+  Group* tag_g  = build_g.tag_g;
 
   if (
     type == SeriesType::Area ||
@@ -1782,11 +2501,24 @@ void Series::Build(
     type == SeriesType::Line ||
     type == SeriesType::Point
   ) {
-    BuildLine(
-      line_g, mark_g, hole_g, tag_g
-    );
+    if (
+      density_cell > 0 &&
+      (type == SeriesType::Scatter || type == SeriesType::Point)
+    ) {
+      BuildDensity( mark_g );
+    } else {
+      BuildLine(
+        line_g, mark_g, hole_g, tag_g
+      );
+    }
   }
 
+  stats->AddSeries(
+    { main->id, id, name, start_ms, stats->Now() - start_ms,
+      datum_y.size(), points_out, worker
+    }
+  );
+
   return;
 }
 
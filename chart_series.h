@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include <chart_common.h>
 #include <chart_datum.h>
 #include <chart_legend_box.h>
@@ -65,10 +67,32 @@ public:
   void SetMarkerSize( SVG::U size );
   void SetMarkerShape( MarkerShape shape );
 
+  // Emit the Square, Triangle, InvTriangle, and Diamond markers of the series
+  // as one compound polygon per marker layer instead of one object per marker.
+  // This greatly reduces the number of SVG objects, but overlapping markers
+  // are then filled only once, which matters if the marker color has
+  // transparency.
+  void SetMarkerCompound( bool compound = true )
+  {
+    marker_compound = compound;
+  }
+
+  // Emit the bar fills of the series as one compound polygon per layer
+  // instead of one rectangle per bar. Bar outlines and lollipop stems are not
+  // affected.
+  void SetBarCompound( bool compound = true ) { bar_compound = compound; }
+
   // Enables tags on data points; will not look good if there are many
-  // data points.
+  // data points unless a tag budget is set.
   void SetTagEnable( bool enable = true ) { tag_enable = enable; }
 
+  // Maximum number of data points to tag; 0 (the default) means no limit. If
+  // the series has more data points, those to tag are chosen by priority: for
+  // bar-type series the largest bars, and otherwise the first and last data
+  // points followed by the local extrema furthest from the mean. The tags of
+  // the other data points are never built.
+  void SetTagBudget( size_t budget ) { tag_budget = budget; }
+
   // Position of the tag relative to the data point.
   void SetTagPos( Pos pos ) { tag_pos = pos; }
 
@@ -100,9 +124,66 @@ public:
     const std::string_view tag_y
   );
 
+  // Add many data points at once; the values are copied. If x and y differ in
+  // size, only the common number of data points are added.
+  void Add( Span< double > x, Span< double > y );
+
+  // Same as above, but the series references the caller's data instead of
+  // copying it. It is the responsibility of the caller to ensure that the data
+  // is not deallocated or modified before the chart is built. The series must
+  // be empty; any subsequent Add() will cause the data to be copied.
+  void AddBorrowed( Span< double > x, Span< double > y );
+
+  // Defines evenly spaced X-values, such that the X-value of data point number
+  // i is start + i*step; the default is start=0 and step=1. The step may also
+  // be negative. As long as all added X-values follow this rule, no X-values
+  // are stored. This is typically the case for series with string X-values,
+  // where the X-value is the category index.
+  void SetImplicitX( double start, double step = 1 );
+
+  // Add Y-values only, using the X-values defined by SetImplicitX().
+  void Add( Span< double > y );
+  void AddBorrowed( Span< double > y );
+
   void SetPruneDist( SVG::U dist ) { prune_dist = dist; }
 
-  uint32_t Size( void ) { return datum_list.size(); }
+  // Reduce the data points of line type series within each pixel column to
+  // the first, min, max, and last data point before the line is built. This
+  // does not change the rendered line, but makes the build time depend on the
+  // chart width rather than on the number of data points. It has no effect if
+  // markers or tags are shown.
+  void SetColumnDecimation( bool enable = true )
+  {
+    column_decimation = enable;
+  }
+
+  // Limit the number of data points of line type series to at most the given
+  // number (2 or more) by downsampling the data using the Largest-Triangle-
+  // Three-Buckets algorithm; 0 means no limit. Unlike SetPruneDist(), this
+  // gives control of the resulting SVG/HTML size. Invalid data points count
+  // against the limit where they break the line; if the line is broken into
+  // too many pieces, neighbouring pieces are joined.
+  void SetMaxPoints( size_t n ) { max_points = n; }
+
+  // Render Scatter and Point series as a density plot instead of markers. The
+  // chart area is divided into square cells of the given size, and each cell
+  // holding data points is shaded according to the number of data points;
+  // 0 disables the density plot, and cell sizes below 1 are taken as 1. Tags
+  // are not shown in this mode.
+  void SetDensity( SVG::U cell_size ) { density_cell = cell_size; }
+
+  // Lines are emitted as SVG polylines of at most the given number of points;
+  // 0 means no limit. Larger polylines give smaller files, while smaller
+  // polylines may render faster in some browsers. The default is 1024.
+  void SetMaxPoly( size_t n ) { max_poly = n; }
+
+  // Round the line and area coordinates to the given number of decimals;
+  // consecutive points that become identical are merged. This reduces the
+  // SVG/HTML size of dense series. A negative value (the default) retains
+  // full precision.
+  void SetCoorDecimals( int decimals ) { coor_decimals = decimals; }
+
+  uint32_t Size( void ) { return datum_y.size(); }
 
   Main* main = nullptr;
 
@@ -113,10 +194,18 @@ public:
   void ApplyTagStyle ( SVG::Object* obj );
 
   // Remove data points that do not contribute significantly to the overall
-  // rendering of the SVG.
-  void PrunePoly( std::vector< SVG::Point >& points, bool no_html = false );
+  // rendering of the SVG. If keep is given, the points are left unchanged and
+  // the retained points are instead flagged in keep.
+  void PrunePoly(
+    std::vector< SVG::Point >& points, bool no_html = false,
+    std::vector< bool >* keep = nullptr
+  );
   void PrunePoints( std::vector< SVG::Point >& points );
 
+  // Occupancy bitmap used by PrunePoints(); it is all zeros between uses.
+  std::vector< uint64_t > prune_bitmap;
+  static constexpr uint64_t prune_bitmap_max = uint64_t( 1 ) << 26;
+
   bool Inside( const SVG::Point p, const SVG::BoundaryBox& bb );
   bool Inside( const SVG::Point p )
   {
@@ -135,6 +224,10 @@ public:
 
   SVG::Point MoveInside( SVG::Point p );
 
+  // Select the data points to tag if there are more than the tag budget;
+  // tag_select is left empty if all data points are to be tagged.
+  void SelectTags( std::vector< bool >& tag_select );
+
   void UpdateLegendBoxes(
     SVG::Point p1, SVG::Point p2,
     bool p1_inc = true, bool p2_inc = true
@@ -175,6 +268,9 @@ public:
     SVG::Group* hole_g,
     SVG::Group* tag_g
   );
+  void BuildDensity(
+    SVG::Group* mark_g
+  );
   void Build(
     SVG::Group* main_g,
     SVG::Group* line_g,
@@ -189,8 +285,47 @@ public:
     std::vector< SVG::Point >* pts_neg = nullptr
   );
 
+  // Build() is split in two parts. BuildGroups() adds the groups of the series
+  // to the given parent groups and must therefore be called in series order,
+  // whereas BuildContent() only adds to the groups of the series itself. The
+  // latter can thus be called concurrently for series which do not stack and
+  // have no tags; note that the legend boxes, snap points, and statistics are
+  // then updated concurrently too.
+  void BuildGroups(
+    SVG::Group* main_g,
+    SVG::Group* line_g,
+    SVG::Group* area_fill_g,
+    SVG::Group* marker_g,
+    SVG::Group* tag_g
+  );
+  void BuildContent(
+    uint32_t bar_num,
+    uint32_t bar_tot,
+    std::vector< double >* ofs_pos = nullptr,
+    std::vector< double >* ofs_neg = nullptr,
+    std::vector< SVG::Point >* pts_pos = nullptr,
+    std::vector< SVG::Point >* pts_neg = nullptr
+  );
+
+  // The groups of the series made by BuildGroups().
+  struct {
+    SVG::Group* fill_g;
+    SVG::Group* tbar_g;
+    SVG::Group* line_g;
+    SVG::Group* mark_g;
+    SVG::Group* hole_g;
+    SVG::Group* tag_g;
+  } build_g = {};
+
   uint32_t id;
 
+  // Number of vertices, markers, bars, or density cells emitted by Build().
+  uint64_t points_out = 0;
+
+  // Worker thread of the chart which built the series, where 0 is the thread
+  // of the chart itself.
+  uint32_t worker = 0;
+
   // The area within which the graphs are plotted.
   SVG::BoundaryBox chart_area;
 
@@ -207,9 +342,22 @@ public:
   double base;
 
   std::vector< LegendBox >* lb_list;
+  const LegendBoxIndex* lb_index;
+
+  // If lb_record is set, the legend box weight increments are recorded in
+  // lb_inc_list instead of being added to lb_list. This allows series built
+  // concurrently to have their weights added in series order afterwards.
+  struct lb_inc_t {
+    uint32_t idx;
+    double   weight1;
+    double   weight2;
+  };
+  bool lb_record = false;
+  std::vector< lb_inc_t > lb_inc_list;
 
   Tag* tag_db;
   bool tag_enable;
+  size_t tag_budget;
   Pos tag_pos;
   float tag_size;
   bool tag_box;
@@ -223,6 +371,8 @@ public:
 
   // Used by Chart::HTML
   bool has_snap = false;
+  std::vector< HTML::snap_point_t > snap_points;
+  std::vector< SVG::Point > dont_prune_points;
   uint32_t line_color_same_cnt = 0;
   uint32_t fill_color_same_cnt = 0;
 
@@ -244,12 +394,104 @@ public:
   uint32_t bar_layer_num = 0;
   uint32_t bar_layer_tot = 1;
 
-  std::vector< Datum > datum_list;
+  // The data points are stored column-wise so that scans over the X- or
+  // Y-values only touch those values. Tags are normally absent, so they are
+  // kept in a separate list ordered by data point index. The data is accessed
+  // through datum_x/datum_y, which either refer to owned_x/owned_y or to
+  // borrowed caller data.
+  Span< double > datum_x;
+  Span< double > datum_y;
+  std::vector< double > owned_x;
+  std::vector< double > owned_y;
+  bool borrowed = false;
+
+  // When x_implicit is set, datum_x is unused and the X-values are computed
+  // from x_start and x_step.
+  bool   x_implicit = true;
+  double x_start = 0;
+  double x_step = 1;
+
+  // Get the X-value of the data point at the given index.
+  double X( size_t idx )
+  {
+    return x_implicit ? (x_start + idx * x_step) : datum_x[ idx ];
+  }
+
+  // Store the X-values explicitly.
+  void ExplicitX( void );
+
+  // Take a private copy of any borrowed data so that it can be modified.
+  void OwnData( void );
+
+  // Make datum_x/datum_y refer to owned_x/owned_y.
+  void SyncData( void )
+  {
+    datum_x = owned_x;
+    datum_y = owned_y;
+  }
+
+  struct tag_t {
+    size_t idx;
+    std::string_view tag_x;
+    std::string_view tag_y;
+  };
+  std::vector< tag_t > tag_list;
+
+  // Assemble the full data point (including any tags) at the given index.
+  Datum GetDatum( size_t idx );
 
   SVG::U prune_dist = 0.0;
 
+  bool column_decimation = false;
+  size_t max_points = 0;
+
+  SVG::U density_cell = 0;
+
+  size_t max_poly = 1024;
+  int    coor_decimals = -1;
+
+  // Round the points to coor_decimals and merge consecutive identical points.
+  void RoundPoints( std::vector< SVG::Point >& points );
+
+  // Add the points to g as a number of polylines of at most max_poly points.
+  void AddPolylines( SVG::Group* g, const std::vector< SVG::Point >& points );
+
+  // Holds the HTML snap point texts of density cells. The snap points refer to
+  // these strings, so they are kept in a deque, where they stay in place as
+  // more are added.
+  std::deque< std::string > density_tags;
+
+  // Number of data points converted to coordinates in one go.
+  static constexpr size_t coor_chunk = 1024;
+
+  // Determine the indices of the data points that remain after reducing each
+  // pixel column to its first, min, max, and last data point. If selected is
+  // true, only the data points already in keep are considered.
+  void DecimateColumns( std::vector< size_t >& keep, bool selected = false );
+
+  // Determine the indices of the data points that remain after downsampling
+  // to max_points data points.
+  void DownsampleLTTB( std::vector< size_t >& keep );
+
   SVG::U      marker_size;
   MarkerShape marker_shape;
+  bool        marker_compound = false;
+
+  bool bar_compound = false;
+
+  // Used to build one polygon from a number of closed shapes, which must be
+  // filled but not outlined. Each shape is traced from and back to its first
+  // vertex. EndCompound() retraces the bridges between the shapes in reverse,
+  // so that the bridges enclose no area and remain invisible.
+  struct compound_t {
+    SVG::Poly* poly = nullptr;
+    std::vector< SVG::Point > bridge;
+  };
+  void AddCompound(
+    compound_t& compound, SVG::Point p,
+    const std::vector< SVG::Point >& shape
+  );
+  void EndCompound( compound_t& compound, SVG::Group* g );
 
   typedef struct {
     SVG::U x1;
@@ -280,6 +522,16 @@ public:
   // Build marker based on marker_* variables.
   void BuildMarker( SVG::Group* g, const MarkerDims& m, SVG::Point p );
 
+  // Get the vertices of the marker relative to its center point. This marker
+  // symbol is computed once and then placed at each marker position.
+  std::vector< SVG::Point > MarkerSymbol( const MarkerDims& m );
+
+  // Build markers at all the given points, as BuildMarker() does for a single
+  // point.
+  void BuildMarkers(
+    SVG::Group* g, const MarkerDims& m, const std::vector< SVG::Point >& points
+  );
+
   // Determine min/max data values.
   void DetermineMinMax(
     std::vector< double >& ofs_pos,
@@ -0,0 +1,126 @@
+//
+//  MIT No Attribution License
+//
+//  Copyright 2024, Soren Kragh
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the
+//  “Software”), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so.
+//
+
+#include <chart_stats.h>
+
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using namespace Chart;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+std::string quoteJSON( const std::string& s )
+{
+  std::ostringstream oss;
+  oss << '"';
+  for ( char c : s ) {
+    if ( static_cast< unsigned char >( c ) < ' ' ) {
+      oss << "\\u" << std::hex << std::setw( 4 ) << std::setfill( '0' )
+          << int( c ) << std::dec;
+    } else if ( c == '"' ) {
+      oss << "\\\"";
+    } else if ( c == '\\' ) {
+      oss << "\\\\";
+    } else {
+      oss << c;
+    }
+  }
+  oss << '"';
+  return oss.str();
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Stats::WriteTrace( std::ostream& os ) const
+{
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision( 3 );
+
+  // Each chart has its own thread, with additional threads for the workers
+  // building the series of the chart concurrently, as events on the same
+  // thread must nest. The threads are identified by (chart+1, worker), and
+  // thread 0 holds the ensemble level phases.
+  std::map< std::pair< int64_t, uint32_t >, int64_t > tid_map;
+  tid_map[ { 0, 0 } ] = 0;
+  for ( const phase_t& phase : phase_list ) {
+    tid_map[ { phase.chart + 1, 0 } ] = 0;
+  }
+  for ( const series_t& series : series_list ) {
+    tid_map[ { int64_t( series.chart ) + 1, series.worker } ] = 0;
+  }
+  int64_t tid_cnt = 0;
+  for ( auto& elem : tid_map ) elem.second = tid_cnt++;
+
+  auto event = [&](
+    const std::string& name, const char* cat, int64_t tid,
+    double start_ms, double time_ms
+  )
+  {
+    oss << "{\"name\":" << quoteJSON( name ) << ",\"cat\":\"" << cat << '"';
+    oss << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid;
+    oss << ",\"ts\":" << start_ms * 1000 << ",\"dur\":" << time_ms * 1000;
+  };
+
+  oss << "{\"traceEvents\":[\n";
+
+  event( "Ensemble::Build", "ensemble", 0, 0, time_ms );
+  oss << ",\"args\":{\"objects\":" << objects << ",\"bytes\":" << bytes;
+  oss << "}},\n";
+
+  for ( const phase_t& phase : phase_list ) {
+    int64_t tid = tid_map[ { phase.chart + 1, 0 } ];
+    event(
+      phase.name, (phase.chart < 0) ? "ensemble" : "chart", tid,
+      phase.start_ms, phase.time_ms
+    );
+    oss << "},\n";
+  }
+
+  for ( const series_t& series : series_list ) {
+    int64_t tid = tid_map[ { int64_t( series.chart ) + 1, series.worker } ];
+    event(
+      "Series " + std::to_string( series.series ) + " " + series.name,
+      "series", tid, series.start_ms, series.time_ms
+    );
+    oss << ",\"args\":{";
+    oss << "\"points_in\":" << series.points_in << ',';
+    oss << "\"points_out\":" << series.points_out;
+    oss << "}},\n";
+  }
+
+  for ( const auto& elem : tid_map ) {
+    int64_t chart = elem.first.first - 1;
+    uint32_t worker = elem.first.second;
+    int64_t tid = elem.second;
+    std::string name =
+      (chart < 0) ? "Ensemble" : ("Chart " + std::to_string( chart ));
+    if ( worker > 0 ) name += " worker " + std::to_string( worker );
+    oss << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid;
+    oss << ",\"args\":{\"name\":" << quoteJSON( name ) << "}},\n";
+    oss << "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+    oss << tid << ",\"args\":{\"sort_index\":" << tid << "}}";
+    oss << ((tid == tid_cnt - 1) ? "\n" : ",\n");
+  }
+
+  oss << "],\"displayTimeUnit\":\"ms\"}\n";
+
+  os << oss.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,172 @@
+//
+//  MIT No Attribution License
+//
+//  Copyright 2024, Soren Kragh
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the
+//  “Software”), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace Chart {
+
+// Statistics collected during Ensemble::Build(). All times are wall clock
+// times in milliseconds, and start times are relative to the start of the
+// build.
+class Stats
+{
+public:
+
+  using Clock = std::chrono::steady_clock;
+
+  struct phase_t {
+    std::string name;
+    int32_t     chart;      // Chart ID, or -1 for the ensemble as a whole.
+    double      start_ms;
+    double      time_ms;
+  };
+
+  struct series_t {
+    uint32_t    chart;
+    uint32_t    series;     // Series ID within the chart.
+    std::string name;
+    double      start_ms;
+    double      time_ms;
+    uint64_t    points_in;  // Number of data points.
+    uint64_t    points_out; // Vertices, markers, bars, or density cells
+                            // emitted after pruning and downsampling.
+    uint32_t    worker;     // Worker thread of the chart which built the
+                            // series, where 0 is the thread of the chart.
+  };
+
+  std::vector< phase_t >  phase_list;
+  std::vector< series_t > series_list;
+
+  double   time_ms = 0;     // Total build time.
+  uint64_t objects = 0;     // Number of SVG elements of the charts.
+  uint64_t bytes   = 0;     // Number of bytes emitted.
+
+  // Add a phase or series; may be called concurrently.
+  void AddPhase( const phase_t& phase )
+  {
+    std::lock_guard< std::mutex > lock( mutex );
+    phase_list.push_back( phase );
+  }
+  void AddSeries( const series_t& series )
+  {
+    std::lock_guard< std::mutex > lock( mutex );
+    series_list.push_back( series );
+  }
+
+  void Reset( void )
+  {
+    phase_list.clear();
+    series_list.clear();
+    time_ms = 0;
+    objects = 0;
+    bytes   = 0;
+    start   = Clock::now();
+  }
+
+  // Write the phases and series as a Chrome trace event JSON file, which can
+  // be viewed in chrome://tracing or Perfetto. The charts are shown as
+  // separate threads with the ensemble level phases on top.
+  void WriteTrace( std::ostream& os ) const;
+
+  // Time since the start of the build.
+  double Now( void )
+  {
+    return
+      std::chrono::duration< double, std::milli >( Clock::now() - start )
+      .count();
+  }
+
+  // Count the number of elements of an SVG document.
+  static uint64_t CountElements( const std::string& svg )
+  {
+    uint64_t n = 0;
+    for ( size_t i = 0; i + 1 < svg.size(); ++i ) {
+      if ( svg[ i ] != '<' ) continue;
+      char c = svg[ i + 1 ];
+      if ( c != '/' && c != '?' && c != '!' ) n++;
+    }
+    return n;
+  }
+
+  // Records the time from construction to destruction as a phase.
+  class Timer
+  {
+  public:
+    Timer( Stats* stats, const std::string& name, int32_t chart = -1 )
+      : stats( stats ), name( name ), chart( chart ), start_ms( stats->Now() )
+    {}
+    ~Timer( void ) { Stop(); }
+
+    // Record the phase now instead of at destruction.
+    void Stop( void )
+    {
+      if ( stopped ) return;
+      stats->AddPhase( { name, chart, start_ms, stats->Now() - start_ms } );
+      stopped = true;
+    }
+  private:
+    Stats*      stats;
+    std::string name;
+    int32_t     chart;
+    double      start_ms;
+    bool        stopped = false;
+  };
+
+  Clock::time_point start = Clock::now();
+  std::mutex        mutex;
+};
+
+// Stream buffer which passes all data on to another stream buffer while
+// counting the number of bytes.
+class CountBuf : public std::streambuf
+{
+public:
+
+  CountBuf( std::streambuf* sb ) : sb( sb ) {}
+
+  uint64_t count = 0;
+
+protected:
+
+  int_type overflow( int_type ch ) override
+  {
+    if ( traits_type::eq_int_type( ch, traits_type::eof() ) ) {
+      return traits_type::not_eof( ch );
+    }
+    count++;
+    return sb->sputc( traits_type::to_char_type( ch ) );
+  }
+
+  std::streamsize xsputn( const char* s, std::streamsize n ) override
+  {
+    std::streamsize m = sb->sputn( s, n );
+    count += m;
+    return m;
+  }
+
+  int sync( void ) override { return sb->pubsync(); }
+
+private:
+
+  std::streambuf* sb;
+};
+
+}
@@ -14,6 +14,7 @@
 #include <chart_tag.h>
 #include <chart_axis.h>
 #include <chart_series.h>
+#include <chart_ensemble.h>
 
 using namespace SVG;
 using namespace Chart;
@@ -33,18 +34,37 @@ Tag::~Tag( void )
 
 void Tag::RecordTag( const SVG::BoundaryBox& bb )
 {
+  tag_grid.Add( recorded_tags.size(), bb );
   recorded_tags.push_back( bb );
 }
 
 bool Tag::Collision( const SVG::BoundaryBox& bb )
 {
+  auto collides = [&]( const BoundaryBox& tag_bb )
+  {
+    return
+      bb.max.x > tag_bb.min.x && bb.min.x < tag_bb.max.x &&
+      bb.max.y > tag_bb.min.y && bb.min.y < tag_bb.max.y;
+  };
+
+  // Check the most recently added tags first since they are the most likely
+  // to collide.
+  size_t n = recorded_tags.size();
+  for ( size_t i = n; i > 0 && i + recent_tags > n; --i ) {
+    if ( collides( recorded_tags[ i - 1 ] ) ) return true;
+  }
+
+  tag_idx_list.clear();
+  if ( tag_grid.Find( bb, 0, 0, tag_idx_list ) ) {
+    for ( uint32_t i : tag_idx_list ) {
+      if ( collides( recorded_tags[ i ] ) ) return true;
+    }
+    return false;
+  }
+
   // Search backwards since most recently added tag is most likely to collide.
   for ( auto it = recorded_tags.crbegin(); it != recorded_tags.crend(); ++it ) {
-    if (
-      bb.max.x > it->min.x && bb.min.x < it->max.x &&
-      bb.max.y > it->min.y && bb.min.y < it->max.y
-    )
-      return true;
+    if ( collides( *it ) ) return true;
   }
   return false;
 }
@@ -57,6 +77,11 @@ SVG::Group* Tag::BuildTag(
 {
   Group* g = tag_g->AddNewGroup();
 
+  TextCache* text_cache = &series->main->ensemble->text_cache;
+  TextCache::font_t font = Font( series->tag_size );
+  auto measure = [&]( void ) { return g->Last()->GetBB(); };
+  BoundaryBox bb;
+
   if (
     series->type == SeriesType::XY ||
     series->type == SeriesType::Scatter
@@ -78,13 +103,14 @@ SVG::Group* Tag::BuildTag(
     s += series->axis_y->number_unit;
     s += ')';
     g->Add( new Text( s ) );
+    bb = text_cache->GetBB( font, s, measure );
   } else {
     std::string s{ datum.tag_y };
     s += series->axis_y->number_unit;
     g->Add( new Text( s ) );
+    bb = text_cache->GetBB( font, s, measure );
   }
 
-  BoundaryBox bb = g->Last()->GetBB();
   r = (bb.max.y - bb.min.y) / 3;
 
   U d = r * 0.75;
@@ -29,10 +29,15 @@ public:
 
   std::vector< SVG::BoundaryBox > recorded_tags;
 
-  // Records and checks tag for collision detection.
+  // Records and checks tag for collision detection. The recorded tags are
+  // kept in a grid so that only the tags near the checked tag are visited.
   void RecordTag( const SVG::BoundaryBox& bb );
   bool Collision( const SVG::BoundaryBox& bb );
 
+  BBGrid tag_grid;
+  static constexpr size_t recent_tags = 8;
+  std::vector< uint32_t > tag_idx_list;
+
   // Used for line and point type series. The connected argument indicates if
   // this point is connected to the previous point. A tag will only be added
   // for valid datum.
@@ -70,6 +75,20 @@ public:
 
   const SVG::U min_base_dist = 2.0;
 
+  // The tag font, where the size is scaled by the tag size of the series. The
+  // size and boldness are set by Series::ApplyTagStyle(), and the factors by
+  // the tag group of Main::Build().
+  static constexpr float font_size       = 12;
+  static constexpr float width_factor    = 1.0;
+  static constexpr float height_factor   = 0.80;
+  static constexpr float baseline_factor = 0.30;
+  static TextCache::font_t Font( float tag_size )
+  {
+    return {
+      font_size * tag_size, width_factor, height_factor, baseline_factor, true
+    };
+  }
+
   SVG::Group* BuildTag(
     Series* series, SVG::Group* tag_g, const Datum& datum, SVG::U& r
   );
@@ -0,0 +1,23 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Runs all the unit tests; the exit status is non-zero if any test failed.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "unit.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main( void )
+{
+  for ( const Unit::test_t& test : Unit::TestList() ) {
+    int failures = Unit::failures;
+    test.func();
+    printf(
+      "%-40s %s\n", test.name, (Unit::failures > failures) ? "FAILED" : "ok"
+    );
+  }
+  return (Unit::failures > 0) ? 1 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
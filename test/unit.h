@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Minimal unit test framework. Test cases are defined with UNIT_TEST() in the
+// unit_*.cpp files, and are all run by the unit executable (make check).
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include <chart_ensemble.h>
+
+namespace Unit {
+
+  struct test_t {
+    const char* name;
+    void (*func)( void );
+  };
+
+  inline std::vector< test_t >& TestList( void )
+  {
+    static std::vector< test_t > test_list;
+    return test_list;
+  }
+
+  inline int failures = 0;
+
+  struct Register {
+    Register( const char* name, void (*func)( void ) )
+    {
+      TestList().push_back( { name, func } );
+    }
+  };
+
+  // Return a new series of the given type, with the axes of its chart
+  // assigned as when the chart is built. The series is added to a new chart,
+  // or to the last chart of the ensemble if new_chart is false.
+  inline Chart::Series* NewSeries(
+    Chart::Ensemble& ensemble, Chart::SeriesType type, bool new_chart = true
+  )
+  {
+    if ( new_chart ) ensemble.NewChart( 0, 0, 0, 0 );
+    Chart::Main* chart = ensemble.LastChart();
+    Chart::Series* series = chart->AddSeries( type );
+    series->axis_x = chart->AxisX();
+    series->axis_y = chart->AxisY();
+    return series;
+  }
+
+}
+
+#define UNIT_TEST( name )                                   \
+  static void name( void );                                 \
+  static Unit::Register name##_register( #name, name );     \
+  static void name( void )
+
+#define CHECK( cond )                                       \
+  do {                                                      \
+    if ( !(cond) ) {                                        \
+      fprintf(                                              \
+        stderr, "%s:%d: CHECK( %s ) failed\n",              \
+        __FILE__, __LINE__, #cond                           \
+      );                                                    \
+      Unit::failures++;                                     \
+    }                                                       \
+  } while ( 0 )
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Unit tests of GzipBuf; the compressed data is decompressed with gzip -d.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "unit.h"
+
+#include <chart_gzip.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+using namespace Chart;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Compress the data with GzipBuf, writing it in chunks of the given size
+// (0 means one character at a time), and decompress it again using gzip.
+static bool RoundTrip( const std::string& data, size_t chunk )
+{
+  char name[] = "/tmp/unit_gzip_XXXXXX";
+  int fd = mkstemp( name );
+  if ( fd < 0 ) return false;
+  close( fd );
+
+  {
+    std::ofstream file( name, std::ios::binary );
+    GzipBuf gz( file );
+    std::ostream os( &gz );
+    for ( size_t i = 0; i < data.size(); ) {
+      if ( chunk == 0 ) {
+        os.put( data[ i++ ] );
+      } else {
+        size_t n = std::min( chunk, data.size() - i );
+        os.write( data.data() + i, n );
+        i += n;
+      }
+    }
+    gz.Finish();
+  }
+
+  std::string out;
+  std::string cmd = std::string( "gzip -dc " ) + name;
+  FILE* pipe = popen( cmd.c_str(), "r" );
+  bool ok = pipe != nullptr;
+  if ( pipe ) {
+    char buf[ 4096 ];
+    size_t n;
+    while ( (n = fread( buf, 1, sizeof( buf ), pipe )) > 0 ) {
+      out.append( buf, n );
+    }
+    ok = pclose( pipe ) == 0;
+  }
+  unlink( name );
+  return ok && out == data;
+}
+
+//-----------------------------------------------------------------------------
+
+UNIT_TEST( GzipEmpty )
+{
+  CHECK( RoundTrip( "", 1 ) );
+}
+
+UNIT_TEST( GzipTiny )
+{
+  CHECK( RoundTrip( "a", 1 ) );
+  CHECK( RoundTrip( "abc", 0 ) );
+  CHECK( RoundTrip( "<svg/>\n", 3 ) );
+}
+
+UNIT_TEST( GzipRepetitive )
+{
+  CHECK( RoundTrip( std::string( 300000, 'x' ), 4096 ) );
+  std::string s;
+  while ( s.size() < 200000 ) s += "abc";
+  CHECK( RoundTrip( s, 0 ) );
+}
+
+// Larger than both the window and the block size, with matches at all
+// distances and incompressible parts.
+UNIT_TEST( GzipLarge )
+{
+  std::mt19937 rng( 1 );
+  std::ostringstream oss;
+  for ( int i = 0; i < 20000; i++ ) {
+    oss << "<path d=\"M" << rng() % 1000 << ' ' << rng() % 1000 << "\"/>\n";
+    if ( i % 1000 == 0 ) {
+      for ( int j = 0; j < 5000; j++ ) oss << char( rng() );
+    }
+  }
+  std::string s = oss.str();
+  CHECK( s.size() > 4 * 65536 );
+  CHECK( RoundTrip( s, 7777 ) );
+  CHECK( RoundTrip( s, 100000 ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,249 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Unit tests of the binary encoding of the HTML snap points. The binary data
+// is decoded the same way as decodeSnapPoints() in chart_html_part2.h does,
+// and compared with the textual encoding of the same chart.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "unit.h"
+
+#include <chart_ensemble.h>
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+using namespace Chart;
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct snap_t {
+  uint32_t    s;
+  bool        x_is_tag;
+  uint32_t    x_cat;
+  std::string x_tag;
+  std::string y;
+  double      X;
+  double      Y;
+};
+
+static std::vector< std::string > tags;
+
+static std::string BuildHTML( bool binary )
+{
+  Ensemble ensemble;
+  ensemble.EnableHTML();
+  ensemble.SetHTMLBinarySnaps( binary );
+
+  if ( tags.empty() ) {
+    for ( int i = 0; i < 50; i++ ) {
+      tags.push_back( "t\"" + std::to_string( i ) );
+    }
+  }
+
+  for ( int s = 0; s < 2; s++ ) {
+    Series* series = Unit::NewSeries( ensemble, SeriesType::XY, s == 0 );
+    series->SetName( "XY" + std::to_string( s ) );
+    for ( int i = 0; i < 100; i++ ) {
+      double y = std::sin( i * 0.1 + s );
+      series->Add( i, y, tags[ i % 50 ], tags[ i % 7 ] );
+    }
+  }
+
+  ensemble.NewChart( 0, 1, 0, 1 );
+  Main* chart = ensemble.LastChart();
+  for ( int i = 0; i < 30; i++ ) {
+    chart->AddCategory( "c" + std::to_string( i ) );
+  }
+  Series* series = Unit::NewSeries( ensemble, SeriesType::Line, false );
+  series->SetName( "Line" );
+  for ( int i = 0; i < 30; i++ ) {
+    series->Add( i, i % 5 - 2.5, "", tags[ i % 3 ] );
+  }
+
+  return ensemble.Build();
+}
+
+//-----------------------------------------------------------------------------
+
+// Parse a quoted JavaScript string starting at pos.
+static std::string ParseString( const std::string& html, size_t& pos )
+{
+  std::string s;
+  pos++;
+  while ( html[ pos ] != '"' ) {
+    if ( html[ pos ] == '\\' ) pos++;
+    s += html[ pos++ ];
+  }
+  pos++;
+  return s;
+}
+
+// Decode base64 like atob() followed by a little-endian typed array.
+static std::vector< uint32_t > DecodeBase64(
+  const std::string& html, size_t& pos
+)
+{
+  std::string s = ParseString( html, pos );
+  std::vector< uint8_t > bytes;
+  uint32_t v = 0;
+  int bits = 0;
+  for ( char c : s ) {
+    if ( c == '=' ) break;
+    const char* digits =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const char* d = std::strchr( digits, c );
+    if ( d == nullptr || c == 0 ) return {};
+    v = (v << 6) | uint32_t( d - digits );
+    bits += 6;
+    if ( bits >= 8 ) {
+      bits -= 8;
+      bytes.push_back( (v >> bits) & 0xFF );
+    }
+  }
+  // A typed array needs a whole number of elements.
+  if ( bytes.size() % 4 != 0 ) return {};
+  std::vector< uint32_t > data;
+  for ( size_t i = 0; i < bytes.size(); i += 4 ) {
+    data.push_back(
+      uint32_t( bytes[ i + 0 ] ) <<  0 | uint32_t( bytes[ i + 1 ] ) <<  8 |
+      uint32_t( bytes[ i + 2 ] ) << 16 | uint32_t( bytes[ i + 3 ] ) << 24
+    );
+  }
+  return data;
+}
+
+// Expect the given text at pos and skip it.
+static bool Expect( const std::string& html, size_t& pos, const char* txt )
+{
+  size_t n = std::strlen( txt );
+  if ( html.compare( pos, n, txt ) != 0 ) return false;
+  pos += n;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+static bool ParseText( const std::string& html, std::vector< snap_t >& list )
+{
+  size_t pos = 0;
+  while ( (pos = html.find( "snapPoints : [\n", pos )) != std::string::npos ) {
+    pos += std::strlen( "snapPoints : [\n" );
+    while ( html[ pos ] == '{' ) {
+      snap_t sp;
+      size_t n;
+      if ( !Expect( html, pos, "{s:" ) ) return false;
+      sp.s = std::stoul( html.substr( pos ), &n ); pos += n;
+      if ( !Expect( html, pos, ",x:" ) ) return false;
+      sp.x_is_tag = html[ pos ] == '"';
+      if ( sp.x_is_tag ) {
+        sp.x_tag = ParseString( html, pos );
+      } else {
+        sp.x_cat = std::stoul( html.substr( pos ), &n ); pos += n;
+      }
+      if ( !Expect( html, pos, ",y:" ) ) return false;
+      sp.y = ParseString( html, pos );
+      if ( !Expect( html, pos, ",X:" ) ) return false;
+      sp.X = std::stod( html.substr( pos ), &n ); pos += n;
+      if ( !Expect( html, pos, ",Y:" ) ) return false;
+      sp.Y = std::stod( html.substr( pos ), &n ); pos += n;
+      if ( !Expect( html, pos, "},\n" ) ) return false;
+      list.push_back( sp );
+    }
+  }
+  return true;
+}
+
+static bool ParseBinary( const std::string& html, std::vector< snap_t >& list )
+{
+  size_t pos = 0;
+  while ( (pos = html.find( "snapData : {\n", pos )) != std::string::npos ) {
+    pos += std::strlen( "snapData : {\n" );
+    size_t n;
+    if ( !Expect( html, pos, "n:" ) ) return false;
+    size_t cnt = std::stoul( html.substr( pos ), &n ); pos += n;
+    if ( !Expect( html, pos, ",\ns:" ) ) return false;
+    std::vector< uint32_t > s = DecodeBase64( html, pos );
+    if ( !Expect( html, pos, ",\nx:" ) ) return false;
+    std::vector< uint32_t > x = DecodeBase64( html, pos );
+    if ( !Expect( html, pos, ",\ny:" ) ) return false;
+    std::vector< uint32_t > y = DecodeBase64( html, pos );
+    if ( !Expect( html, pos, ",\np:" ) ) return false;
+    std::vector< uint32_t > p = DecodeBase64( html, pos );
+    if ( !Expect( html, pos, ",\nt:[\n" ) ) return false;
+    std::vector< std::string > t;
+    while ( html[ pos ] == '"' ) {
+      t.push_back( ParseString( html, pos ) );
+      if ( !Expect( html, pos, ",\n" ) ) return false;
+    }
+    if ( !Expect( html, pos, "],\n},\n" ) ) return false;
+    if (
+      s.size() != cnt || x.size() != cnt || y.size() != cnt ||
+      p.size() != 2 * cnt
+    ) {
+      return false;
+    }
+    for ( size_t i = 0; i < cnt; i++ ) {
+      snap_t sp;
+      sp.s = s[ i ];
+      int32_t xi = int32_t( x[ i ] );
+      sp.x_is_tag = xi < 0;
+      if ( sp.x_is_tag ) {
+        if ( size_t( -1 - xi ) >= t.size() ) return false;
+        sp.x_tag = t[ -1 - xi ];
+      } else {
+        sp.x_cat = xi;
+      }
+      if ( y[ i ] >= t.size() ) return false;
+      sp.y = t[ y[ i ] ];
+      float f[ 2 ];
+      std::memcpy( f, &p[ 2 * i ], sizeof( f ) );
+      sp.X = f[ 0 ];
+      sp.Y = f[ 1 ];
+      list.push_back( sp );
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+UNIT_TEST( HtmlBinarySnaps )
+{
+  std::string txt_html = BuildHTML( false );
+  std::string bin_html = BuildHTML( true );
+  CHECK( bin_html.find( "snapPoints : [" ) == std::string::npos );
+  CHECK( txt_html.find( "snapData : {" ) == std::string::npos );
+
+  std::vector< snap_t > txt_list;
+  std::vector< snap_t > bin_list;
+  CHECK( ParseText( txt_html, txt_list ) );
+  CHECK( ParseBinary( bin_html, bin_list ) );
+  CHECK( !txt_list.empty() );
+  CHECK( txt_list.size() == bin_list.size() );
+  if ( txt_list.size() != bin_list.size() ) return;
+
+  bool has_tag_x = false;
+  bool has_cat_x = false;
+  for ( size_t i = 0; i < txt_list.size(); i++ ) {
+    const snap_t& a = txt_list[ i ];
+    const snap_t& b = bin_list[ i ];
+    CHECK( a.s == b.s );
+    CHECK( a.x_is_tag == b.x_is_tag );
+    if ( a.x_is_tag ) {
+      CHECK( a.x_tag == b.x_tag );
+      has_tag_x = true;
+    } else {
+      CHECK( a.x_cat == b.x_cat );
+      has_cat_x = true;
+    }
+    CHECK( a.y == b.y );
+    CHECK( std::abs( a.X - b.X ) < 0.01 );
+    CHECK( std::abs( a.Y - b.Y ) < 0.01 );
+  }
+  CHECK( has_tag_x );
+  CHECK( has_cat_x );
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Unit tests of the LTTB downsampling of Series::SetMaxPoints().
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "unit.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <chart_ensemble.h>
+
+using namespace Chart;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Downsample the given Y-values with implicit X-values.
+static std::vector< size_t > Downsample(
+  const std::vector< double >& y, size_t max_points
+)
+{
+  Ensemble ensemble;
+  Series* series = Unit::NewSeries( ensemble, SeriesType::XY );
+  series->Add( y );
+  series->SetMaxPoints( max_points );
+  std::vector< size_t > keep;
+  series->DownsampleLTTB( keep );
+  return keep;
+}
+
+static bool Increasing( const std::vector< size_t >& keep )
+{
+  for ( size_t i = 1; i < keep.size(); i++ ) {
+    if ( keep[ i ] <= keep[ i - 1 ] ) return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+UNIT_TEST( LttbPointCount )
+{
+  std::vector< double > y;
+  for ( size_t i = 0; i < 10000; i++ ) {
+    y.push_back( std::sin( i / 100.0 ) + std::sin( i * 0.37 ) / 10 );
+  }
+  for ( size_t max_points : { 3, 10, 100, 1234 } ) {
+    std::vector< size_t > keep = Downsample( y, max_points );
+    CHECK( keep.size() == max_points );
+    CHECK( keep.front() == 0 );
+    CHECK( keep.back() == y.size() - 1 );
+    CHECK( Increasing( keep ) );
+  }
+
+  // Nothing to downsample.
+  std::vector< size_t > keep = Downsample( { 1, 2, 3 }, 10 );
+  CHECK( keep == std::vector< size_t >( { 0, 1, 2 } ) );
+}
+
+// A lone spike forms the largest triangle within its bucket.
+UNIT_TEST( LttbKeepsSpike )
+{
+  std::vector< double > y( 1000, 0.0 );
+  y[ 567 ] = 10;
+  std::vector< size_t > keep = Downsample( y, 20 );
+  CHECK( keep.size() == 20 );
+  CHECK( std::find( keep.begin(), keep.end(), 567 ) != keep.end() );
+}
+
+// Invalid data points break the line; they are kept, and each run of valid
+// data points is downsampled separately with its own endpoints.
+UNIT_TEST( LttbInvalidBreak )
+{
+  std::vector< double > y;
+  for ( size_t i = 0; i < 1000; i++ ) y.push_back( std::sin( i / 10.0 ) );
+  y[ 500 ] = num_invalid;
+  y[ 700 ] = num_skip;
+  std::vector< size_t > keep = Downsample( y, 50 );
+  CHECK( Increasing( keep ) );
+  CHECK( keep.front() == 0 );
+  CHECK( keep.back() == 999 );
+  auto has = [&]( size_t idx ) {
+    return std::find( keep.begin(), keep.end(), idx ) != keep.end();
+  };
+  CHECK( has( 499 ) );
+  CHECK( has( 500 ) );
+  CHECK( has( 501 ) );
+  CHECK( !has( 700 ) );
+  // The budget is split over the two runs (500 and 498 valid data points)
+  // in proportion to their length, plus the break.
+  CHECK( keep.size() == 25 + 24 + 1 );
+}
+
+// Many invalid data points must not make the result exceed the budget.
+UNIT_TEST( LttbManyBreaks )
+{
+  std::vector< double > y;
+  for ( size_t i = 0; i < 100000; i++ ) {
+    y.push_back( (i % 20 == 7) ? num_invalid : std::sin( i / 100.0 ) );
+  }
+  y[ 1000 ] = num_skip;
+  y[ 1001 ] = num_invalid;
+  for ( size_t max_points : { 2, 3, 10, 1000, 5000, 20000 } ) {
+    std::vector< size_t > keep = Downsample( y, max_points );
+    CHECK( keep.size() == max_points );
+    CHECK( Increasing( keep ) );
+    CHECK( keep.front() == 0 );
+    CHECK( keep.back() == y.size() - 1 );
+    for ( size_t idx : keep ) CHECK( y[ idx ] != num_skip );
+  }
+
+  // Runs of single valid data points.
+  y.assign( 100000, num_invalid );
+  for ( size_t i = 0; i < y.size(); i += 2 ) y[ i ] = i % 3;
+  for ( size_t max_points : { 3, 100, 1000 } ) {
+    std::vector< size_t > keep = Downsample( y, max_points );
+    CHECK( keep.size() <= max_points );
+    CHECK( keep.size() >= max_points * 3 / 4 - 1 );
+    CHECK( Increasing( keep ) );
+  }
+
+  // Few breaks leave the budget to the valid data points.
+  y.assign( 100000, 1.0 );
+  for ( size_t i = 1; i <= 9; i++ ) y[ i * 10000 ] = num_invalid;
+  std::vector< size_t > keep = Downsample( y, 1000 );
+  CHECK( keep.size() == 1000 );
+  for ( size_t i = 1; i <= 9; i++ ) {
+    CHECK( std::find( keep.begin(), keep.end(), i * 10000 ) != keep.end() );
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Unit tests of the Series data ingestion.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "unit.h"
+
+#include <chart_ensemble.h>
+
+using namespace Chart;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Check that the series holds exactly the given data points.
+static bool SameData(
+  Series* series,
+  const std::vector< double >& x, const std::vector< double >& y
+)
+{
+  if ( series->datum_y.size() != y.size() ) return false;
+  for ( size_t i = 0; i < y.size(); i++ ) {
+    if ( series->X( i ) != x[ i ] || series->datum_y[ i ] != y[ i ] ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+UNIT_TEST( SeriesAddSpan )
+{
+  Ensemble ensemble;
+  Series* series = Unit::NewSeries( ensemble, SeriesType::XY );
+
+  std::vector< double > x{ 1, 2, 3 };
+  std::vector< double > y{ 4, 5, 6, 7 };
+  series->Add( x, y );
+  CHECK( !series->borrowed );
+  CHECK( SameData( series, { 1, 2, 3 }, { 4, 5, 6 } ) );
+
+  // The data is copied.
+  x[ 0 ] = 0;
+  CHECK( SameData( series, { 1, 2, 3 }, { 4, 5, 6 } ) );
+}
+
+UNIT_TEST( SeriesAddBorrowed )
+{
+  Ensemble ensemble;
+  Series* series = Unit::NewSeries( ensemble, SeriesType::XY );
+
+  std::vector< double > x{ 1, 2, 3 };
+  std::vector< double > y{ 4, 5, 6 };
+  series->AddBorrowed( x, y );
+  CHECK( series->borrowed );
+  CHECK( series->datum_y.data() == y.data() );
+  CHECK( SameData( series, { 1, 2, 3 }, { 4, 5, 6 } ) );
+}
+
+// Appending to borrowed data must copy the borrowed data first.
+UNIT_TEST( SeriesAppendToBorrowed )
+{
+  Ensemble ensemble;
+
+  std::vector< double > x{ 1, 2, 3 };
+  std::vector< double > y{ 4, 5, 6 };
+
+  Series* s1 = Unit::NewSeries( ensemble, SeriesType::XY );
+  s1->AddBorrowed( x, y );
+  s1->Add( std::vector< double >{ 7, 8 }, std::vector< double >{ 9, 10 } );
+  CHECK( !s1->borrowed );
+  CHECK( SameData( s1, { 1, 2, 3, 7, 8 }, { 4, 5, 6, 9, 10 } ) );
+
+  Series* s2 = Unit::NewSeries( ensemble, SeriesType::XY );
+  s2->AddBorrowed( x, y );
+  s2->Add( 7, 9 );
+  CHECK( SameData( s2, { 1, 2, 3, 7 }, { 4, 5, 6, 9 } ) );
+
+  Series* s3 = Unit::NewSeries( ensemble, SeriesType::XY );
+  s3->AddBorrowed( x, y );
+  s3->AddBorrowed( std::vector< double >{ 7 }, std::vector< double >{ 9 } );
+  CHECK( SameData( s3, { 1, 2, 3, 7 }, { 4, 5, 6, 9 } ) );
+
+  Series* s4 = Unit::NewSeries( ensemble, SeriesType::Line );
+  s4->AddBorrowed( y );
+  s4->Add( std::vector< double >{ 9, 10 } );
+  CHECK( SameData( s4, { 0, 1, 2, 3, 4 }, { 4, 5, 6, 9, 10 } ) );
+
+  // The caller's data is never modified.
+  CHECK( x == std::vector< double >( { 1, 2, 3 } ) );
+  CHECK( y == std::vector< double >( { 4, 5, 6 } ) );
+}
+
+UNIT_TEST( SeriesImplicitX )
+{
+  Ensemble ensemble;
+  Series* series = Unit::NewSeries( ensemble, SeriesType::Line );
+
+  series->SetImplicitX( 10, 2 );
+  std::vector< double > y{ 4, 5, 6 };
+  series->AddBorrowed( y );
+  CHECK( series->x_implicit );
+  CHECK( series->borrowed );
+  CHECK( SameData( series, { 10, 12, 14 }, { 4, 5, 6 } ) );
+
+  // Following the rule keeps the X-values implicit.
+  series->Add( 16, 7 );
+  CHECK( series->x_implicit );
+  CHECK( !series->borrowed );
+
+  // Breaking the rule makes them explicit.
+  series->Add( 17, 8 );
+  CHECK( !series->x_implicit );
+  CHECK( SameData( series, { 10, 12, 14, 16, 17 }, { 4, 5, 6, 7, 8 } ) );
+}
+
+// The X-range of decreasing implicit X-values is still in order.
+UNIT_TEST( SeriesImplicitXNegativeStep )
+{
+  Ensemble ensemble;
+  Series* series = Unit::NewSeries( ensemble, SeriesType::Line );
+
+  series->SetImplicitX( 100, -1 );
+  std::vector< double > y{ 4, 5, 6, 7, 8, 9, 8, 7, 6, num_invalid };
+  series->Add( y );
+  CHECK( series->x_implicit );
+  CHECK( series->X( 9 ) == 91 );
+
+  std::vector< double > ofs_pos;
+  std::vector< double > ofs_neg;
+  series->DetermineMinMax( ofs_pos, ofs_neg );
+  CHECK( series->def_x );
+  CHECK( series->min_x == 92 );
+  CHECK( series->max_x == 100 );
+  CHECK( series->min_y == 4 );
+  CHECK( series->max_y == 9 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Unit tests of the grid-indexed tag collision detection.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "unit.h"
+
+#include <chart_tag.h>
+
+#include <random>
+
+using namespace Chart;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static SVG::BoundaryBox BB( double x1, double y1, double x2, double y2 )
+{
+  SVG::BoundaryBox bb;
+  bb.min.x = x1;
+  bb.min.y = y1;
+  bb.max.x = x2;
+  bb.max.y = y2;
+  return bb;
+}
+
+// The collision check without the grid.
+static bool LinearCollision(
+  const std::vector< SVG::BoundaryBox >& tags, const SVG::BoundaryBox& bb
+)
+{
+  for ( const auto& t : tags ) {
+    if (
+      bb.max.x > t.min.x && bb.min.x < t.max.x &&
+      bb.max.y > t.min.y && bb.min.y < t.max.y
+    ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+
+// Tags ending exactly on a cell boundary (the cells are 32x32) touch, but do
+// not collide with, tags starting there.
+UNIT_TEST( TagGridCellBoundary )
+{
+  Tag tag;
+  // Enough tags that the most recent ones do not cover the checks below.
+  for ( int i = 0; i < 20; i++ ) {
+    tag.RecordTag( BB( 1000 + 40 * i, 1000, 1020 + 40 * i, 1010 ) );
+  }
+  tag.RecordTag( BB( 0, 0, 32, 32 ) );
+  tag.RecordTag( BB( -64, -32, -32, 0 ) );
+  for ( int i = 0; i < 20; i++ ) {
+    tag.RecordTag( BB( 2000 + 40 * i, 1000, 2020 + 40 * i, 1010 ) );
+  }
+
+  CHECK( !tag.Collision( BB( 32, 0, 64, 32 ) ) );
+  CHECK( !tag.Collision( BB( 0, 32, 32, 64 ) ) );
+  CHECK( !tag.Collision( BB( -32, -32, 0, 0 ) ) );
+  CHECK( !tag.Collision( BB( -96, -32, -64, 0 ) ) );
+  CHECK( !tag.Collision( BB( 32, 32, 40, 40 ) ) );
+
+  CHECK( tag.Collision( BB( 31.9, 0, 64, 32 ) ) );
+  CHECK( tag.Collision( BB( 0, 31.9, 32, 64 ) ) );
+  CHECK( tag.Collision( BB( 16, 16, 17, 17 ) ) );
+  CHECK( tag.Collision( BB( -33, -1, -31, 1 ) ) );
+  CHECK( tag.Collision( BB( -40, -8, -39, -7 ) ) );
+
+  // Crossing a cell boundary by a fraction.
+  tag.RecordTag( BB( 32, 100, 40, 110 ) );
+  tag.RecordTag( BB( -40, 200, -32, 210 ) );
+  for ( int i = 0; i < 20; i++ ) {
+    tag.RecordTag( BB( 3000 + 40 * i, 1000, 3020 + 40 * i, 1010 ) );
+  }
+  CHECK( tag.Collision( BB( 0, 100, 32.25, 110 ) ) );
+  CHECK( !tag.Collision( BB( 0, 100, 32, 110 ) ) );
+  CHECK( tag.Collision( BB( -32.25, 200, 0, 210 ) ) );
+  CHECK( !tag.Collision( BB( -32, 200, 0, 210 ) ) );
+
+  // Spanning many cells around the recorded tags.
+  CHECK( tag.Collision( BB( -1000, -1000, 1000, 1000 ) ) );
+  CHECK( !tag.Collision( BB( -1000, 300, 1000, 900 ) ) );
+}
+
+// Compare with the linear check for random tags at or very near the
+// boundaries of an 8x8 grid, which is aligned with the cells.
+UNIT_TEST( TagGridRandom )
+{
+  std::mt19937 rng( 1 );
+  auto coor = [&]( void ) {
+    double jitter = 0.25 * (int( rng() % 3 ) - 1);
+    return double( int( rng() % 81 ) - 40 ) * 8 + jitter;
+  };
+  auto size = [&]( void ) { return double( rng() % 12 ) * 8; };
+
+  Tag tag;
+  std::vector< SVG::BoundaryBox > tags;
+  for ( int i = 0; i < 200; i++ ) {
+    double x = coor();
+    double y = coor();
+    SVG::BoundaryBox bb = BB( x, y, x + size(), y + size() );
+    if ( rng() % 50 == 0 ) bb = BB( x, y, x + 1000, y + 1000 );
+    bool collision = tag.Collision( bb );
+    CHECK( collision == LinearCollision( tags, bb ) );
+    if ( !collision ) {
+      tag.RecordTag( bb );
+      tags.push_back( bb );
+    }
+  }
+  CHECK( tags.size() > 20 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Unit tests of the tag budget priority selection, Series::SelectTags().
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "unit.h"
+
+#include <chart_ensemble.h>
+
+using namespace Chart;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Return the indices of the data points selected for tagging, or all the
+// data points if there is no selection.
+static std::vector< size_t > Select(
+  SeriesType type, const std::vector< double >& y, size_t budget,
+  double base = 0
+)
+{
+  Ensemble ensemble;
+  Series* series = Unit::NewSeries( ensemble, type );
+  series->SetBase( base );
+  series->SetTagEnable();
+  series->SetTagBudget( budget );
+  series->Add( y );
+
+  std::vector< bool > tag_select;
+  series->SelectTags( tag_select );
+  std::vector< size_t > idx_list;
+  for ( size_t idx = 0; idx < y.size(); idx++ ) {
+    if ( tag_select.empty() || tag_select[ idx ] ) idx_list.push_back( idx );
+  }
+  return idx_list;
+}
+
+using idx_list_t = std::vector< size_t >;
+
+//-----------------------------------------------------------------------------
+
+// The first and last data points go first, followed by the local extrema
+// furthest from the mean (3.15).
+UNIT_TEST( TagBudgetLine )
+{
+  std::vector< double > y{ 1, 4, 2, 2, 7, 3, 0.5, 6, 5, 1 };
+  CHECK( Select( SeriesType::Line, y, 2 ) == idx_list_t( { 0, 9 } ) );
+  CHECK( Select( SeriesType::Line, y, 3 ) == idx_list_t( { 0, 4, 9 } ) );
+  CHECK( Select( SeriesType::Line, y, 4 ) == idx_list_t( { 0, 4, 7, 9 } ) );
+  CHECK(
+    Select( SeriesType::Line, y, 5 ) == idx_list_t( { 0, 4, 6, 7, 9 } )
+  );
+  // The extrema (1, 2, 4, 6, 7) go before the other data points (3, 5, 8),
+  // even if those are further from the mean.
+  CHECK(
+    Select( SeriesType::Line, y, 7 ) ==
+    idx_list_t( { 0, 1, 2, 4, 6, 7, 9 } )
+  );
+}
+
+// Invalid data points are never tagged, and do not count as neighbours when
+// finding the local extrema.
+UNIT_TEST( TagBudgetInvalid )
+{
+  std::vector< double > y{ 1, 4, num_invalid, 9, 2, 3, 1, num_skip };
+  // Valid data points: 0, 1, 3, 4, 5, 6; 1 is not an extremum as 9 follows.
+  CHECK( Select( SeriesType::Line, y, 3 ) == idx_list_t( { 0, 3, 6 } ) );
+  CHECK( Select( SeriesType::Line, y, 4 ) == idx_list_t( { 0, 3, 4, 6 } ) );
+}
+
+// Bar-type series tag the largest bars relative to the base.
+UNIT_TEST( TagBudgetBar )
+{
+  std::vector< double > y{ 1, -9, 3, 8, -2 };
+  CHECK( Select( SeriesType::Bar, y, 2 ) == idx_list_t( { 1, 3 } ) );
+  CHECK( Select( SeriesType::Bar, y, 2, 5 ) == idx_list_t( { 1, 4 } ) );
+  CHECK( Select( SeriesType::Lollipop, y, 1 ) == idx_list_t( { 1 } ) );
+}
+
+// No selection when the budget is unlimited or not exceeded.
+UNIT_TEST( TagBudgetUnlimited )
+{
+  std::vector< double > y{ 1, 2, 3 };
+  CHECK( Select( SeriesType::Line, y, 0 ) == idx_list_t( { 0, 1, 2 } ) );
+  CHECK( Select( SeriesType::Line, y, 3 ) == idx_list_t( { 0, 1, 2 } ) );
+  CHECK( Select( SeriesType::Bar, y, 5 ) == idx_list_t( { 0, 1, 2 } ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Unit tests of the concurrent building of charts and series; the output must
+// not depend on the number of threads.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "unit.h"
+
+#include <cmath>
+#include <string>
+
+#include <chart_ensemble.h>
+
+using namespace Chart;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static std::vector< std::string > tags;
+
+static std::string BuildEnsemble( uint32_t threads, bool html )
+{
+  Ensemble ensemble;
+  ensemble.SetThreads( threads );
+  ensemble.EnableHTML( html );
+  ensemble.SetTitle( "Threads" );
+  ensemble.SetLegendHeading( "Global" );
+
+  if ( tags.empty() ) {
+    for ( int i = 0; i < 100; i++ ) tags.push_back( std::to_string( i ) );
+  }
+
+  const SeriesType type_list[] = {
+    SeriesType::XY, SeriesType::Scatter, SeriesType::Line,
+    SeriesType::Bar, SeriesType::StackedArea, SeriesType::Lollipop
+  };
+  for ( int c = 0; c < 6; c++ ) {
+    SeriesType type = type_list[ c ];
+    bool cat = type != SeriesType::XY && type != SeriesType::Scatter;
+    int n = cat ? 30 : 500;
+    ensemble.NewChart( c / 3, c % 3, c / 3, c % 3 );
+    Main* chart = ensemble.LastChart();
+    chart->SetTitle( "Chart " + std::to_string( c ) );
+    if ( cat ) {
+      for ( int i = 0; i < n; i++ ) {
+        chart->AddCategory( "c" + std::to_string( i ) );
+      }
+    }
+    for ( int s = 0; s < 4; s++ ) {
+      Series* series = Unit::NewSeries( ensemble, type, false );
+      series->SetName( "S" + std::to_string( s ) );
+      series->SetGlobalLegend( s == 3 );
+      if ( s == 1 ) series->SetTagEnable();
+      for ( int i = 0; i < n; i++ ) {
+        double x = cat ? i : i * 0.37 + std::sin( i * 7.1 ) * (c + 1);
+        double y = std::sin( i * 0.05 + s ) * 10 + (i * 7919 % 13) * 0.3;
+        if ( i % 97 == 50 ) y = num_invalid;
+        series->Add( x, y, tags[ i % 100 ], tags[ (i * 3) % 100 ] );
+      }
+    }
+  }
+
+  return ensemble.Build();
+}
+
+//-----------------------------------------------------------------------------
+
+UNIT_TEST( ThreadsSameOutput )
+{
+  for ( bool html : { false, true } ) {
+    std::string out = BuildEnsemble( 1, html );
+    CHECK( out.size() > 10000 );
+    CHECK( BuildEnsemble( 8, html ) == out );
+    CHECK( BuildEnsemble( 8, html ) == out );
+    CHECK( BuildEnsemble( 3, html ) == out );
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////